@@ -0,0 +1,136 @@
+#pragma once
+
+#include <types.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace g923mac {
+    struct calibration_options {
+        bool led_sweep{true}; // false skips the 2 s led sweep, the force and autocenter steps still run
+        std::atomic<bool> const *cancel{nullptr}; // set to abandon calibration at the next step
+    };
+
+    /// calibrates every item on its own thread, so startup costs one calibration however many items there are
+    /// the items belong to the worker until ready(), which is an acquire: once it is true the calibrated items
+    /// have been handed to `publish` and everything written to them is visible to the reader
+    /// an item still calibrating at the deadline is cancelled and left out, the others do not wait for it
+    template<typename T>
+    class calibration_worker {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        calibration_worker() noexcept = default;
+
+        calibration_worker(calibration_worker const &) = delete;
+        calibration_worker &operator=(calibration_worker const &) = delete;
+
+        ~calibration_worker() { stop(); }
+
+        bool ready() const noexcept { return ready_.load(std::memory_order_acquire); }
+
+        /// items that missed the deadline, valid once ready()
+        std::size_t timed_out() const noexcept { return timed_out_.load(std::memory_order_relaxed); }
+
+        /// `calibrate(T &, calibration_options const &) -> bool` runs once per item on that item's thread,
+        /// `publish(vector<T> &&)` receives the items that calibrated, on the worker thread, right before ready()
+        template<typename Calibrate, typename Publish>
+        void start(vector<T> items, bool led_sweep, clock::duration timeout, Calibrate calibrate, Publish publish) {
+            if (coordinator_.joinable()) return;
+
+            ready_.store(false, std::memory_order_relaxed);
+            timed_out_.store(0, std::memory_order_relaxed);
+            jobs_.clear();
+
+            for (T &item: items) {
+                jobs_.push_back(std::make_unique<job>(std::move(item)));
+            }
+            for (auto &j: jobs_) {
+                j->thread = std::thread([ &j = *j, led_sweep, calibrate ]() mutable {
+                    j.calibrated = calibrate(j.item, calibration_options{led_sweep, &j.cancel});
+                    j.done.store(true, std::memory_order_release);
+                });
+            }
+
+            coordinator_ = std::thread([ this, deadline = clock::now() + timeout, publish = std::move(publish) ]() mutable {
+                _join(deadline, publish);
+            });
+        }
+
+        /// cancels whatever is still calibrating and returns once every thread has exited,
+        /// a device blocked inside a write holds this up until the write returns
+        void stop() {
+            if (!coordinator_.joinable()) return;
+
+            for (auto &j: jobs_) j->cancel.store(true, std::memory_order_relaxed);
+
+            coordinator_.join();
+            for (auto &j: jobs_) {
+                if (j->thread.joinable()) j->thread.join();
+            }
+            jobs_.clear();
+        }
+
+    private:
+        struct job {
+            explicit job(T &&item) noexcept : item(std::move(item)) {
+            }
+
+            T item;
+            std::thread thread;
+            std::atomic<bool> cancel{false};
+            std::atomic<bool> done{false};
+            bool calibrated{false}; // written before done is released
+        };
+
+        vector<std::unique_ptr<job>> jobs_;
+        std::thread coordinator_;
+        std::atomic<bool> ready_{false};
+        std::atomic<std::size_t> timed_out_{0};
+
+        template<typename Publish>
+        void _join(clock::time_point deadline, Publish &publish) {
+            constexpr std::chrono::milliseconds poll{10};
+
+            vector<T> calibrated;
+            std::size_t timed_out{0};
+
+            for (auto &j: jobs_) {
+                while (!j->done.load(std::memory_order_acquire) && clock::now() < deadline) {
+                    std::this_thread::sleep_for(poll);
+                }
+
+                if (!j->done.load(std::memory_order_acquire)) {
+                    // the thread keeps its item until stop(), it may still be inside a write
+                    j->cancel.store(true, std::memory_order_relaxed);
+                    ++timed_out;
+                    continue;
+                }
+
+                j->thread.join();
+                if (j->calibrated) calibrated.push_back(std::move(j->item));
+            }
+
+            timed_out_.store(timed_out, std::memory_order_relaxed);
+            publish(std::move(calibrated));
+            ready_.store(true, std::memory_order_release);
+        }
+    };
+
+    /// sleeps `duration` in short slices, false as soon as the calibration is cancelled
+    inline bool calibration_wait(calibration_options const &options, std::chrono::milliseconds duration) noexcept {
+        constexpr std::chrono::milliseconds slice{10};
+
+        auto const until = std::chrono::steady_clock::now() + duration;
+
+        for (auto now = std::chrono::steady_clock::now(); now < until; now = std::chrono::steady_clock::now()) {
+            if (options.cancel && options.cancel->load(std::memory_order_relaxed)) return false;
+
+            std::this_thread::sleep_for(until - now < slice ? until - now : slice);
+        }
+        return !(options.cancel && options.cancel->load(std::memory_order_relaxed));
+    }
+}
@@ -1,8 +1,12 @@
 #pragma once
 
 #include <types.hpp>
+#include <histogram.hpp>
+#include <array>
+#include <chrono>
+#include <cstddef>
 
-#define G923MAC_CMD_MAX_COUNT 4
+#define G923MAC_CMD_MAX_COUNT 8
 #define G923MAC_CMD_MAX_LEN   8
 
 namespace g923mac {
@@ -10,22 +14,172 @@ namespace g923mac {
         std::uint8_t cmd[G923MAC_CMD_MAX_LEN];
     };
 
-    constexpr IOReturn send_report(hid_device const &device, report const &report) {
+    /// the command byte with the slot mask of 0x?1 downloads and 0x?3 stops widened to all slots
+    constexpr std::uint8_t opcode_of(report const &rep) noexcept {
+        std::uint8_t const command = rep.cmd[0] & 0x0F;
+
+        return command == 0x01 || command == 0x03 ? static_cast<std::uint8_t>(0xF0 | command) : rep.cmd[0];
+    }
+
+    /// device slots a download or stop addresses, one bit per slot
+    constexpr std::uint8_t slot_mask_of(report const &rep) noexcept {
+        return static_cast<std::uint8_t>(rep.cmd[0] >> 4);
+    }
+
+    /// identifies the effect a report drives: opcode in the high byte, effect type for downloads
+    constexpr std::uint16_t command_key(report const &rep) noexcept {
+        std::uint8_t const opcode = opcode_of(rep);
+
+        return static_cast<std::uint16_t>((opcode << 8) | (opcode == 0xF1 ? rep.cmd[1] : 0x00));
+    }
+
+    /// device state a report writes, a later report for the same slot supersedes an earlier one
+    enum class command_slot : std::uint8_t {
+        constant,
+        spring,
+        damper,
+        trapezoid,
+        stop,
+        autocenter, // 0xF4 and 0xF5 toggle the same state
+        autocenter_spring,
+        leds,
+        count
+    };
+
+    constexpr std::size_t command_slot_count = static_cast<std::size_t>(command_slot::count);
+
+    /// `command_slot::count` for reports that do not map to a slot
+    constexpr command_slot slot_of(report const &rep) noexcept {
+        switch (command_key(rep)) {
+            case 0xF100: return command_slot::constant;
+            case 0xF101: return command_slot::spring;
+            case 0xF102: return command_slot::damper;
+            case 0xF106: return command_slot::trapezoid;
+            case 0xF300: return command_slot::stop;
+            case 0xF400:
+            case 0xF500: return command_slot::autocenter;
+            case 0xFE00: return command_slot::autocenter_spring;
+            case 0xF800: return command_slot::leds;
+            default: return command_slot::count;
+        }
+    }
+
+    /// fixed-capacity set of reports written together, lives on the stack
+    template<std::size_t Capacity = G923MAC_CMD_MAX_COUNT>
+    class report_batch {
+    public:
+        static constexpr std::size_t capacity() noexcept { return Capacity; }
+
+        constexpr std::size_t size() const noexcept { return size_; }
+        constexpr bool empty() const noexcept { return size_ == 0; }
+        constexpr bool full() const noexcept { return size_ == Capacity; }
+
+        constexpr bool push(report const &rep) noexcept {
+            if (full()) return false;
+
+            reports_[size_++] = rep;
+            return true;
+        }
+
+        constexpr void clear() noexcept { size_ = 0; }
+
+        constexpr report const *begin() const noexcept { return reports_.data(); }
+        constexpr report const *end() const noexcept { return reports_.data() + size_; }
+
+    private:
+        std::array<report, Capacity> reports_{};
+        std::size_t size_{0};
+    };
+
+    /// commands with their own write latency histogram
+    enum class command_metric : std::uint8_t {
+        constant, // 0xF1 0x00
+        spring, // 0xF1 0x01
+        damper, // 0xF1 0x02
+        trapezoid, // 0xF1 0x06
+        stop, // 0xF3
+        enable_autocenter, // 0xF4
+        disable_autocenter, // 0xF5
+        leds, // 0xF8
+        autocenter_spring, // 0xFE
+        other,
+        count
+    };
+
+    constexpr std::size_t command_metric_count = static_cast<std::size_t>(command_metric::count);
+
+    constexpr command_metric metric_of(report const &rep) noexcept {
+        switch (command_key(rep)) {
+            case 0xF100: return command_metric::constant;
+            case 0xF101: return command_metric::spring;
+            case 0xF102: return command_metric::damper;
+            case 0xF106: return command_metric::trapezoid;
+            case 0xF300: return command_metric::stop;
+            case 0xF400: return command_metric::enable_autocenter;
+            case 0xF500: return command_metric::disable_autocenter;
+            case 0xF800: return command_metric::leds;
+            case 0xFE00: return command_metric::autocenter_spring;
+            default: return command_metric::other;
+        }
+    }
+
+    constexpr char const *metric_name(command_metric metric) noexcept {
+        switch (metric) {
+            case command_metric::constant: return "f1/00 constant";
+            case command_metric::spring: return "f1/01 spring";
+            case command_metric::damper: return "f1/02 damper";
+            case command_metric::trapezoid: return "f1/06 trapezoid";
+            case command_metric::stop: return "f3 stop";
+            case command_metric::enable_autocenter: return "f4 autocenter on";
+            case command_metric::disable_autocenter: return "f5 autocenter off";
+            case command_metric::leds: return "f8 leds";
+            case command_metric::autocenter_spring: return "fe autocenter spring";
+            default: return "other";
+        }
+    }
+
+    /// time spent in the transport write, per command, across all devices
+    class write_latency_table {
+    public:
+        void record(report const &rep, std::chrono::nanoseconds duration) noexcept {
+            histograms_[static_cast<std::size_t>(metric_of(rep))].record(duration);
+        }
+
+        latency_summary summary(command_metric metric) const noexcept {
+            return histograms_[static_cast<std::size_t>(metric)].summary();
+        }
+
+        void reset() noexcept {
+            for (auto &histogram: histograms_) histogram.reset();
+        }
+
+    private:
+        std::array<log_linear_histogram<>, command_metric_count> histograms_;
+    };
+
+    inline write_latency_table &write_latencies() noexcept {
+        static write_latency_table table;
+        return table;
+    }
+
+    inline io_result_t send_report(hid_device const &device, report const &report) {
         std::uint8_t const *cmd = &report.cmd[0];
 
-        IOReturn result = IOHIDDeviceSetReport(device.hid_device_, kIOHIDReportTypeOutput, time(nullptr), cmd,
-                                               G923MAC_CMD_MAX_LEN);
+        auto const start = std::chrono::steady_clock::now();
+        io_result_t result = transport::write(device.hid_device_, cmd, G923MAC_CMD_MAX_LEN);
+        write_latencies().record(report, std::chrono::steady_clock::now() - start);
 
         return result;
     }
 
-    constexpr IOReturn send_report(hid_device const &device, vector<report> const &reports) {
-        IOReturn result;
+    template<std::size_t Capacity>
+    io_result_t send_report(hid_device const &device, report_batch<Capacity> const &reports) {
+        io_result_t result = io_success;
 
         for (auto const &report: reports) {
             result = send_report(device, report);
 
-            if (result != kIOReturnSuccess) break ;
+            if (result != io_success) break ;
         }
 
         return result;
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <force_feedback_config.hpp>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace g923mac {
+    /// a function of speed sampled at the centers of equal buckets at compile time
+    /// evaluation interpolates linearly between the two nearest centers and clamps past either end, no branches
+    template<std::size_t Buckets, std::size_t Columns>
+    struct speed_table {
+        static_assert(Buckets >= 2);
+
+        using row = std::array<float, Columns>;
+
+        float bucket_width;
+        std::array<row, Buckets> rows;
+
+        /// `sample(float speed) -> row` is evaluated once per bucket, at its center
+        template<typename Sample>
+        static constexpr speed_table generate(float bucket_width, Sample &&sample) {
+            speed_table table{bucket_width, {}};
+
+            for (std::size_t i = 0; i < Buckets; ++i) table.rows[i] = sample(table.center(i));
+
+            return table;
+        }
+
+        constexpr float center(std::size_t bucket) const noexcept {
+            return (static_cast<float>(bucket) + 0.5f) * bucket_width;
+        }
+
+        constexpr row at(float speed) const noexcept {
+            float const position = std::clamp(speed / bucket_width - 0.5f, 0.0f, static_cast<float>(Buckets - 1));
+            std::size_t const low = std::min(static_cast<std::size_t>(position), Buckets - 2);
+            float const t = position - static_cast<float>(low);
+
+            row const &a = rows[low];
+            row const &b = rows[low + 1];
+            row result{};
+
+            for (std::size_t column = 0; column < Columns; ++column) {
+                result[column] = a[column] * (1.0f - t) + b[column] * t;
+            }
+            return result;
+        }
+    };
+
+    /// steering feel by speed, before the self-aligning torque and power steering are applied
+    enum steering_column : std::size_t {
+        center_base, // centering force
+        center_sat_gain, // centering force added per unit of self-aligning torque
+        center_cap, // most centering force
+        center_slope,
+        damper_pos, // damping before the power steering multiplier
+        damper_neg,
+        damper_cap, // most damping after the power steering multiplier
+        assist_engine_on, // power steering multiplier with the engine running
+        assist_engine_off,
+        steering_column_count
+    };
+
+    using steering_row = std::array<float, steering_column_count>;
+
+    /// the speed bands of a profile as table columns, `speed_kmh` is the absolute speed
+    constexpr steering_row steering_curve_sample(force_profile const &config, float speed_kmh) noexcept {
+        constexpr float no_cap = 255.0f;
+        // the stationary threshold is compared against the speed in m/s
+        float const stationary_kmh = config.speed_stationary_threshold * 3.6f;
+
+        steering_row row{};
+
+        row[assist_engine_on] = speed_kmh < 10.0f ? 0.7f : speed_kmh < 30.0f ? 0.8f : 0.9f;
+        row[assist_engine_off] = speed_kmh < 10.0f ? 2.0f : speed_kmh < 30.0f ? 1.6f : 1.3f;
+
+        if (speed_kmh < stationary_kmh) {
+            row[center_base] = config.center_stationary_force;
+            row[center_cap] = no_cap;
+            row[center_slope] = config.center_stationary_slope;
+            row[damper_pos] = config.damper_stationary_pos;
+            row[damper_neg] = config.damper_stationary_neg;
+            row[damper_cap] = no_cap;
+        } else if (speed_kmh < config.speed_low_threshold) {
+            row[center_base] = config.center_low_speed_base + speed_kmh * config.center_low_speed_factor;
+            row[center_cap] = no_cap;
+            row[center_slope] = 2.0f;
+            row[damper_pos] = config.damper_low_speed;
+            row[damper_neg] = config.damper_low_speed;
+            row[damper_cap] = no_cap;
+        } else {
+            row[center_base] = config.center_highway_base;
+            row[center_sat_gain] = config.center_highway_factor;
+            row[center_cap] = config.center_max_force;
+            row[center_slope] = speed_kmh < config.speed_medium_threshold ? 2.0f :
+                                speed_kmh < config.speed_high_threshold ? 3.0f :
+                                speed_kmh < config.speed_very_high_threshold ? 4.0f : 5.0f;
+            row[damper_pos] = 1.0f + speed_kmh / config.damper_speed_factor;
+            row[damper_neg] = row[damper_pos];
+            row[damper_cap] = config.damper_max;
+        }
+        return row;
+    }
+
+    /// 2 km/h buckets up to 200 km/h, past that every column has settled or is capped
+    using steering_table = speed_table<100, steering_column_count>;
+
+    constexpr steering_table make_steering_curve(force_profile const &profile) noexcept {
+        return steering_table::generate(2.0f, [ & ](float speed_kmh) {
+            return steering_curve_sample(profile, speed_kmh);
+        });
+    }
+
+    /// the steering curve of the default profile
+    constexpr steering_table steering_curve = make_steering_curve(force_profile{});
+
+    /// the feel a steering row gives, what the centering and power steering stages hand on
+    struct steering_feel {
+        float autocenter_force;
+        float autocenter_slope;
+        float damper_pos;
+        float damper_neg;
+        float power_steering_multiplier;
+    };
+
+    constexpr steering_feel steering_feel_of(steering_row const &row, float self_align_torque, bool assisted,
+                                             float centering_multiplier) noexcept {
+        float const assist = assisted ? row[assist_engine_on] : row[assist_engine_off];
+
+        return steering_feel{
+            std::min(row[center_cap], (row[center_base] + self_align_torque * row[center_sat_gain]) *
+                                      centering_multiplier),
+            row[center_slope],
+            std::min(row[damper_cap], row[damper_pos] * assist),
+            std::min(row[damper_cap], row[damper_neg] * assist),
+            assist
+        };
+    }
+
+    namespace detail {
+        // the piecewise speed bands the steering curve replaced, nothing evaluates them at run time; they stay as
+        // the reference the static_asserts below compare the table against
+        constexpr steering_feel steering_feel_piecewise(force_profile const &config, float speed_kmh,
+                                                        float self_align_torque, bool assisted,
+                                                        float centering_multiplier) noexcept {
+            float power_steering_multiplier;
+            if (assisted) {
+                power_steering_multiplier = speed_kmh < 10.0f ? 0.7f : speed_kmh < 30.0f ? 0.8f : 0.9f;
+            } else {
+                power_steering_multiplier = speed_kmh < 10.0f ? 2.0f : speed_kmh < 30.0f ? 1.6f : 1.3f;
+            }
+
+            steering_feel feel{0.0f, 0.0f, 0.0f, 0.0f, power_steering_multiplier};
+
+            if (speed_kmh / 3.6f < config.speed_stationary_threshold) {
+                feel.autocenter_force = config.center_stationary_force * centering_multiplier;
+                feel.autocenter_slope = config.center_stationary_slope;
+                feel.damper_pos = config.damper_stationary_pos * power_steering_multiplier;
+                feel.damper_neg = config.damper_stationary_neg * power_steering_multiplier;
+            } else if (speed_kmh < config.speed_low_threshold) {
+                feel.autocenter_force = (config.center_low_speed_base + speed_kmh * config.center_low_speed_factor) *
+                                        centering_multiplier;
+                feel.autocenter_slope = 2.0f;
+                feel.damper_pos = config.damper_low_speed * power_steering_multiplier;
+                feel.damper_neg = config.damper_low_speed * power_steering_multiplier;
+            } else {
+                feel.autocenter_force = std::min(config.center_max_force,
+                                                 (config.center_highway_base +
+                                                  self_align_torque * config.center_highway_factor) *
+                                                 centering_multiplier);
+
+                if (speed_kmh < config.speed_medium_threshold) feel.autocenter_slope = 2.0f;
+                else if (speed_kmh < config.speed_high_threshold) feel.autocenter_slope = 3.0f;
+                else if (speed_kmh < config.speed_very_high_threshold) feel.autocenter_slope = 4.0f;
+                else feel.autocenter_slope = 5.0f;
+
+                feel.damper_pos = std::min(config.damper_max,
+                                           (1.0f + speed_kmh / config.damper_speed_factor) * power_steering_multiplier);
+                feel.damper_neg = feel.damper_pos;
+            }
+            return feel;
+        }
+
+        constexpr bool near(float a, float b) noexcept {
+            return (a > b ? a - b : b - a) <= 1e-4f * (1.0f + (a > b ? a : b));
+        }
+
+        constexpr bool steering_curve_matches(float self_align_torque, bool assisted, float centering) noexcept {
+            for (std::size_t i = 0; i < steering_curve.rows.size(); ++i) {
+                float const speed = steering_curve.center(i);
+
+                steering_feel const table = steering_feel_of(steering_curve.at(speed), self_align_torque, assisted,
+                                                             centering);
+                steering_feel const piecewise = steering_feel_piecewise(force_profile{}, speed, self_align_torque,
+                                                                        assisted, centering);
+
+                if (!near(table.autocenter_force, piecewise.autocenter_force) ||
+                    !near(table.autocenter_slope, piecewise.autocenter_slope) ||
+                    !near(table.damper_pos, piecewise.damper_pos) || !near(table.damper_neg, piecewise.damper_neg) ||
+                    !near(table.power_steering_multiplier, piecewise.power_steering_multiplier)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    }
+
+    // the steering curve agrees with the piecewise bands at every bucket center, engine running or off, with and
+    // without self-aligning torque
+    static_assert(detail::steering_curve_matches(0.0f, true, 0.7f));
+    static_assert(detail::steering_curve_matches(0.0f, false, 1.0f));
+    static_assert(detail::steering_curve_matches(40.0f, true, 0.7f));
+    static_assert(detail::steering_curve_matches(40.0f, false, 1.0f));
+}
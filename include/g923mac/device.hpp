@@ -3,50 +3,49 @@
 #include <types.hpp>
 #include <iterator>
 #include <algorithm>
+#include <span>
 
 #define make_device_id(productID, vendorID) ( ( ( ( productID ) % 0xFFFF ) << 16 ) | ( ( vendorID ) & 0xFFFF ) )
 
 namespace g923mac {
-    constexpr void set_applier_function_copy_to_cfarray(void const *value, void *context);
-    constexpr CFStringRef get_property_string(IOHIDDeviceRef hid_device, CFStringRef property);
-    constexpr std::uint32_t get_property_number(IOHIDDeviceRef hid_device, CFStringRef property);
-    constexpr IOReturn open_device(hid_device const &device);
-    constexpr IOReturn close_device(hid_device const &device);
+    io_result_t open_device(hid_device const &device);
+    io_result_t close_device(hid_device const &device);
 
+    /// enumerates only the devices matching `device_ids`, the list is cached until a device comes or goes
     class device_manager {
     public:
-        constexpr device_manager() noexcept : hid_manager_(_create_hid_manager()) {
+        explicit device_manager(std::span<device_id_t const> device_ids = known_wheel_ids) noexcept
+            : enumerator_(device_ids) {
         }
 
-        constexpr auto list_devices() -> vector<hid_device> {
-            vector<hid_device> dev_set;
+        device_manager(device_manager const &) = delete;
+        device_manager &operator=(device_manager const &) = delete;
 
-            CFSetRef device_setref = IOHIDManagerCopyDevices(hid_manager_);
-            CFIndex count = CFSetGetCount(device_setref);
+        /// the next list_devices() enumerates again
+        void invalidate() noexcept { cached_ = false; }
 
-            CFMutableArrayRef device_arrayref = CFArrayCreateMutable(kCFAllocatorDefault, 0, &kCFTypeArrayCallBacks);
+        auto list_devices() -> vector<hid_device> const & {
+            std::uint64_t const generation = enumerator_.generation();
 
-            CFSetApplyFunction(device_setref, set_applier_function_copy_to_cfarray,
-                               static_cast<void *>(device_arrayref));
-
-            for (CFIndex i = 0; i < count; ++i) {
-                hid_device_t *device = (hid_device_t *) CFArrayGetValueAtIndex(device_arrayref, i);
-
-                std::uint32_t vendor_id = get_property_number(device, CFSTR(kIOHIDVendorIDKey));
-                std::uint32_t product_id = get_property_number(device, CFSTR(kIOHIDProductIDKey));
+            if (cached_ && generation == generation_) return devices_;
 
+            devices_.clear();
+            enumerator_.for_each([ & ](std::uint32_t vendor_id, std::uint32_t product_id, hid_device_t *device) {
                 device_id_t device_id = make_device_id(product_id, vendor_id);
 
                 hid_device device_data{vendor_id, product_id, device_id, device};
 
-                dev_set.push_back(device_data);
-            }
+                devices_.push_back(device_data);
+            });
+
+            generation_ = generation;
+            cached_ = true;
 
-            return dev_set;
+            return devices_;
         }
 
-        constexpr auto find_known_wheels() -> vector<hid_device> {
-            vector<hid_device> dev_set = list_devices();
+        auto find_known_wheels() -> vector<hid_device> {
+            vector<hid_device> const &dev_set = list_devices();
             vector<hid_device> wheels;
 
             std::copy_if(dev_set.begin(), dev_set.end(), std::back_inserter(wheels),
@@ -59,50 +58,18 @@ namespace g923mac {
             return wheels;
         }
 
-        constexpr ~device_manager() { _destroy_hid_manager(hid_manager_); }
-
     private:
-        hid_manager_t *hid_manager_;
-
-        constexpr hid_manager_t *_create_hid_manager() {
-            hid_manager_t *manager = IOHIDManagerCreate(kCFAllocatorDefault, kIOHIDManagerOptionNone);
-            IOHIDManagerSetDeviceMatching(manager, NULL);
-            IOHIDManagerOpen(manager, kIOHIDOptionsTypeSeizeDevice);
-
-            return manager;
-        }
-
-        constexpr void _destroy_hid_manager(hid_manager_t *manager) {
-            IOHIDManagerClose(manager, kIOHIDManagerOptionNone);
-        }
+        transport::enumerator enumerator_;
+        vector<hid_device> devices_;
+        std::uint64_t generation_{0};
+        bool cached_{false};
     };
 
-    constexpr void set_applier_function_copy_to_cfarray(void const *value, void *context) {
-        CFArrayAppendValue(static_cast<CFMutableArrayRef>(context), value);
-    }
-
-    constexpr CFStringRef get_property_string(hid_device_t *hid_device, CFStringRef property) {
-        CFTypeRef data_ref = IOHIDDeviceGetProperty(hid_device, property);
-        return CFStringCreateCopy(kCFAllocatorDefault, CFStringRef(data_ref));
-    }
-
-    constexpr std::uint32_t get_property_number(hid_device_t *hid_device, CFStringRef property) {
-        CFTypeRef data_ref = IOHIDDeviceGetProperty(hid_device, property);
-
-        if (data_ref && (CFNumberGetTypeID() == CFGetTypeID(data_ref))) {
-            std::uint32_t number;
-            CFNumberGetValue((CFNumberRef) data_ref, kCFNumberSInt32Type, &number);
-            return number;
-        }
-
-        return 0;
-    }
-
-    constexpr IOReturn open_device(hid_device const &device) {
-        return IOHIDDeviceOpen(device.hid_device_, kIOHIDOptionsTypeSeizeDevice);
+    inline io_result_t open_device(hid_device const &device) {
+        return transport::open(device.hid_device_);
     }
 
-    constexpr IOReturn close_device(hid_device const &device) {
-        return IOHIDDeviceClose(device.hid_device_, 0);
+    inline io_result_t close_device(hid_device const &device) {
+        return transport::close(device.hid_device_);
     }
 }
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <types.hpp>
+#include <command.hpp>
+#include <array>
+#include <cstdint>
+
+namespace g923mac {
+    /// effect types, the second byte of a download
+    enum class effect_slot : std::uint8_t {
+        constant = 0x00,
+        spring = 0x01,
+        damper = 0x02,
+        trapezoid = 0x06,
+    };
+
+    /// the device slot each effect type is downloaded to, as a slot mask bit
+    constexpr std::uint8_t effect_slot_bit(std::uint8_t type) noexcept {
+        switch (type) {
+            case static_cast<std::uint8_t>(effect_slot::constant): return 0x01;
+            case static_cast<std::uint8_t>(effect_slot::spring): return 0x02;
+            case static_cast<std::uint8_t>(effect_slot::damper): return 0x04;
+            case static_cast<std::uint8_t>(effect_slot::trapezoid): return 0x08;
+            default: return 0x00;
+        }
+    }
+
+    /// the effect downloads wanted on the device for one update, at most one per slot
+    class effect_set {
+    public:
+        constexpr bool play(report const &download) noexcept {
+            if (opcode_of(download) != 0xF1) return false;
+
+            std::uint8_t const bit = effect_slot_bit(download.cmd[1]);
+            if (bit == 0 || slot_mask_of(download) != bit) return false;
+
+            if (!(mask_ & bit)) {
+                downloads_[count_++] = download;
+                mask_ |= bit;
+            } else {
+                for (std::size_t i = 0; i < count_; ++i) {
+                    if (downloads_[i].cmd[1] == download.cmd[1]) downloads_[i] = download;
+                }
+            }
+            return true;
+        }
+
+        constexpr std::uint8_t mask() const noexcept { return mask_; }
+
+        constexpr report const *begin() const noexcept { return downloads_.data(); }
+        constexpr report const *end() const noexcept { return downloads_.data() + count_; }
+
+    private:
+        std::array<report, 4> downloads_{};
+        std::size_t count_{0};
+        std::uint8_t mask_{0};
+    };
+
+    /// which slots are playing on the device, following the reports handed to it
+    class effect_slots {
+    public:
+        constexpr std::uint8_t active() const noexcept { return active_; }
+
+        constexpr bool active(effect_slot slot) const noexcept {
+            return active_ & effect_slot_bit(static_cast<std::uint8_t>(slot));
+        }
+
+        constexpr void commit(report const &rep) noexcept {
+            switch (opcode_of(rep)) {
+                case 0xF1:
+                    active_ |= slot_mask_of(rep);
+                    break ;
+                case 0xF3:
+                    active_ &= static_cast<std::uint8_t>(~slot_mask_of(rep));
+                    break ;
+                default:
+                    break ;
+            }
+        }
+
+        /// downloads to the slots already playing update them in place, only the slots no longer wanted are
+        /// stopped; `stop(mask)` builds the stop for a slot mask
+        template<std::size_t Capacity, typename Stop>
+        constexpr void stage(effect_set const &wanted, Stop const &stop,
+                             report_batch<Capacity> &batch) const noexcept {
+            std::uint8_t const dropped = active_ & static_cast<std::uint8_t>(~wanted.mask());
+
+            if (dropped != 0) batch.push(stop(dropped));
+
+            for (auto const &download: wanted) batch.push(download);
+        }
+
+    private:
+        std::uint8_t active_{0};
+    };
+}
@@ -1,10 +1,37 @@
 #pragma once
 
+#include <cstddef>
+
 namespace g923mac {
     struct ffb_config {
-        // Update rates (lower = more frequent updates)
-        static constexpr int force_update_rate = 8; // Force feedback update every 8 frames
-        static constexpr int led_update_rate = 32; // LED update every 32 frames
+        // Update rates, independent of the game frame rate
+        static constexpr int force_update_hz = 250; // Force loop rate (250, 500 or 1000 Hz)
+        static constexpr int led_update_hz = 2; // LED update rate, also the flash rate at redline / parking brake
+
+        // Adaptive force rate, backs off while the usb transport cannot keep up
+        static constexpr int force_update_min_hz = 60; // Lowest force loop rate under backpressure
+        static constexpr int force_update_max_hz = 500; // Cap on force_update_hz, the rate recovery returns to
+        static constexpr int force_update_step_hz = 25; // Rate regained per healthy window
+        static constexpr int rate_window_ms = 250; // How often backpressure is measured and the rate adjusted
+        static constexpr int backpressure_latency_high_us = 2000; // Mean write time that counts as congested
+        static constexpr int backpressure_latency_low_us = 1200; // Mean write time that counts as healthy
+        static constexpr std::size_t backpressure_backlog_high = 8; // Waiting reports that count as congested
+        static constexpr std::size_t backpressure_backlog_low = 2; // Waiting reports that count as healthy
+
+        // Startup
+        static constexpr bool calibration_led_sweep = true; // LED sweep while calibrating, false for a ~2 s faster start
+        static constexpr int calibration_timeout_ms = 4000; // A wheel still calibrating after this (~2.9 s) is left out
+        static constexpr int hotplug_poll_interval_ms = 500; // How often wheels plugged in or pulled out are looked for
+
+        // Report transport
+        static constexpr int shadow_refresh_interval_ms = 1000; // Resend unchanged reports this often (0 = never)
+        static constexpr int report_interval_us = 1000; // Interrupt-out interval, minimum spacing between writes
+        static constexpr int report_interval_max_us = 8000; // Widest write spacing under backpressure
+        static constexpr int disconnected_probe_interval_ms = 1000; // Write attempts to a vanished wheel this often
+
+        // Force profile, a file next to the plugin overriding the force knobs below, reloaded when it changes
+        static constexpr char const *profile_file_name = "g923mac.profile";
+        static constexpr int profile_poll_interval_ms = 1000; // How often the profile file is checked for changes
 
         // Self-aligning torque parameters
         static constexpr float sat_base_torque_factor = 0.8f; // Base self-aligning torque multiplier
@@ -74,11 +101,22 @@ namespace g923mac {
         static constexpr float terrain_impact_duration = 0.5f; // Increased duration of impact effects in seconds
         static constexpr float terrain_smoothing_factor = 0.8f; // Smoothing factor for terrain transitions
 
+        // Effect integration, stateful effects advance by the simulation time between frames
+        static constexpr float effect_reference_step = 1.0f / 60.0f; // Step (s) the per-step factors were tuned at
+        static constexpr float effect_max_step = 0.1f; // Longer gaps (s), e.g. after a pause, are clamped to this
+
+        // Latency compensation, steering / yaw rate / lateral G are extrapolated past the frame they came from
+        static constexpr float prediction_lookahead = 0.02f; // Frame delay + usb write to cover (s), 0 disables
+        static constexpr float prediction_max_lookahead = 0.05f; // Cap (s) once the age of the frame is added
+        static constexpr bool prediction_evaluation = false; // Record frames, log prediction error on shutdown
+        static constexpr int prediction_record_capacity = 36000; // Frames kept for evaluation (10 min at 60 fps)
+
         // Steering kickback simulation
         static constexpr float kickback_threshold = 2.0f; // Angular acceleration threshold
         static constexpr float kickback_speed_threshold = 5.0f; // Speed threshold for kickback
         static constexpr float kickback_factor = 10.0f; // Angular acceleration to force multiplier
         static constexpr float kickback_max_force = 40.0f; // Maximum kickback force
+        static constexpr float kickback_duration = 0.1f; // How long (s) a kickback keeps pushing once triggered
 
         // Weight transfer effects
         static constexpr float weight_transfer_threshold = 0.2f; // Longitudinal G threshold
@@ -104,4 +142,30 @@ namespace g923mac {
         static constexpr float led_rpm_step3 = 800.0f;
         static constexpr float led_rpm_step4 = 1000.0f;
     };
+
+    /// every force knob of ffb_config a profile can override, `knob(name)` is expanded once per knob
+#define G923MAC_FORCE_PROFILE_KNOBS(knob) \
+    knob(sat_base_torque_factor) knob(sat_speed_reduction_start) knob(sat_speed_reduction_range) \
+    knob(sat_min_factor) knob(sat_lateral_g_factor) knob(sat_max_lateral_reduction) \
+    knob(center_stationary_force) knob(center_stationary_slope) knob(center_low_speed_base) \
+    knob(center_low_speed_factor) knob(center_highway_base) knob(center_highway_factor) knob(center_max_force) \
+    knob(speed_stationary_threshold) knob(speed_low_threshold) knob(speed_medium_threshold) \
+    knob(speed_high_threshold) knob(speed_very_high_threshold) \
+    knob(damper_stationary_pos) knob(damper_stationary_neg) knob(damper_low_speed) knob(damper_speed_factor) \
+    knob(damper_max) knob(damper_brake_factor) knob(damper_retarder_factor) knob(damper_engine_brake_factor) \
+    knob(damper_max_total) \
+    knob(yaw_rate_threshold) knob(yaw_rate_factor) knob(yaw_max_factor) knob(understeer_factor) \
+    knob(oversteer_reduction) knob(oversteer_damping_add) \
+    knob(terrain_offroad_multiplier) knob(terrain_detection_threshold) knob(terrain_minor_threshold) \
+    knob(terrain_major_threshold) knob(terrain_impact_duration) knob(terrain_smoothing_factor) \
+    knob(kickback_threshold) knob(kickback_speed_threshold) knob(kickback_factor) knob(kickback_max_force) \
+    knob(kickback_duration) \
+    knob(parking_brake_force) knob(parking_brake_slope) knob(parking_brake_damper)
+
+    /// the force knobs as values, a default constructed profile is ffb_config and usable at compile time
+    struct force_profile {
+#define G923MAC_FORCE_PROFILE_FIELD(name) float name{ffb_config::name};
+        G923MAC_FORCE_PROFILE_KNOBS(G923MAC_FORCE_PROFILE_FIELD)
+#undef G923MAC_FORCE_PROFILE_FIELD
+    };
 }
@@ -0,0 +1,379 @@
+#pragma once
+
+#include <telemetry.hpp>
+#include <pipeline.hpp>
+#include <mixer.hpp>
+#include <curves.hpp>
+#include <profile.hpp>
+#include <force_feedback_config.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace g923mac {
+    /// effect state carried from one force update to the next
+    struct terrain_state_t {
+        float smoothed_roughness;
+        float impact_timer;
+        float last_vertical_accel;
+        float impact_cooldown;
+        float kickback_timer;
+        float kickback_force;
+    };
+
+    /// what the stages of one force update read and write, in stage order
+    struct force_context {
+        force_context(telemetry_state_t const &telemetry, float dt, terrain_state_t &terrain,
+                      resolved_profile const &profile) noexcept
+            : telemetry(telemetry),
+              terrain(terrain),
+              profile(profile),
+              dt(dt),
+              new_frame(dt > 0.0f),
+              speed_kmh(telemetry.speed * 3.6f), // Convert m/s to km/h
+              abs_speed(std::abs(telemetry.speed)) {
+        }
+
+        telemetry_state_t const &telemetry;
+        terrain_state_t &terrain;
+        resolved_profile const &profile; // the tuning of this update
+
+        float const dt; // simulation time (s) since the previous update, zero when no new frame arrived since
+        bool const new_frame;
+        float const speed_kmh;
+        float const abs_speed;
+
+        // terrain detection
+        float current_roughness{0.0f};
+        bool on_minor_bump{false};
+        bool on_rough_terrain{false};
+        bool on_major_terrain{false};
+
+        // steering feel
+        float self_align_torque{0.0f};
+        steering_row steering{}; // the steering curve at this speed
+        bool assisted{false}; // power steering running
+        float power_steering_multiplier{1.0f};
+        float centering_multiplier{1.0f};
+
+        force_mix mix{}; // quantized once, after the last stage
+    };
+
+    /// classifies the road surface and advances the impact timers, runs every update
+    struct terrain_detection_stage {
+        static constexpr char const *name = "terrain detection";
+
+        constexpr bool active(force_context const &) const noexcept { return true; }
+
+        void apply(force_context &ctx) const noexcept {
+            force_profile const &config = ctx.profile.values;
+
+            telemetry_state_t const &telemetry = ctx.telemetry;
+            terrain_state_t &terrain = ctx.terrain;
+
+            float const vertical_acceleration = telemetry.linear_acceleration_y;
+            float const abs_vertical_accel = std::abs(vertical_acceleration);
+
+            // Detect sudden impacts (curbs, potholes, road edges) - only use vertical acceleration for terrain detection
+            // The change is scaled to a reference step so the thresholds mean the same at any frame rate
+            float const accel_change = ctx.new_frame ? std::abs(vertical_acceleration - terrain.last_vertical_accel) *
+                                                       (ffb_config::effect_reference_step / ctx.dt) : 0.0f;
+
+            // Filtering to avoid normal driving vibrations
+            bool const is_high_speed = ctx.abs_speed > 40.0f;
+            bool const is_turning = std::abs(telemetry.angular_velocity_y) > 0.1f;
+            bool const is_accelerating = std::abs(telemetry.linear_acceleration_z) > 1.0f;
+            float impact_threshold = config.terrain_minor_threshold * 5.0f;
+
+            if (is_high_speed) {
+                impact_threshold *= 3.0f;
+            }
+            if (is_turning) {
+                impact_threshold *= 2.5f;
+            }
+            if (is_accelerating) {
+                impact_threshold *= 2.0f;
+            }
+
+            bool const sudden_impact = (accel_change > impact_threshold) && // Must exceed dynamic threshold AND
+                                       ((abs_vertical_accel > (impact_threshold * 2.0f)) ||
+                                        // High upward/downward acceleration OR
+                                        (accel_change > (impact_threshold * 1.5f))) &&
+                                       // Significant change from last frame AND
+                                       (accel_change > 0.12f); // Must be a significant change (0.12G minimum)
+
+            ctx.current_roughness = abs_vertical_accel / 9.81f;
+            float const smoothing = std::pow(config.terrain_smoothing_factor,
+                                             ctx.dt / ffb_config::effect_reference_step);
+            terrain.smoothed_roughness = terrain.smoothed_roughness * smoothing +
+                                         ctx.current_roughness * (1.0f - smoothing);
+
+            ctx.on_minor_bump = ctx.current_roughness > (config.terrain_minor_threshold * 3.0f);
+            ctx.on_rough_terrain = terrain.smoothed_roughness > (config.terrain_detection_threshold * 3.0f);
+            ctx.on_major_terrain = terrain.smoothed_roughness > (config.terrain_major_threshold * 2.0f);
+
+            // Only detect new impacts if not in cooldown period
+            if (sudden_impact && ctx.abs_speed > 3.0f && terrain.impact_cooldown <= 0.0f) {
+                terrain.impact_timer = config.terrain_impact_duration * 0.25f;
+                terrain.impact_cooldown = 0.6f;
+            }
+
+            if (terrain.impact_timer > 0.0f) {
+                terrain.impact_timer -= ctx.dt;
+                terrain.impact_timer = std::max(0.0f, terrain.impact_timer);
+            }
+
+            if (terrain.impact_cooldown > 0.0f) {
+                terrain.impact_cooldown -= ctx.dt;
+                terrain.impact_cooldown = std::max(0.0f, terrain.impact_cooldown);
+            }
+        }
+    };
+
+    /// self-aligning torque of the front axle, nothing while stationary
+    struct self_align_stage {
+        static constexpr char const *name = "self-aligning torque";
+
+        constexpr bool active(force_context const &ctx) const noexcept {
+            return ctx.abs_speed > ctx.profile.values.speed_stationary_threshold;
+        }
+
+        void apply(force_context &ctx) const noexcept {
+            force_profile const &config = ctx.profile.values;
+
+            float const lateral_g = ctx.telemetry.linear_acceleration_x / 9.81f;
+
+            ctx.self_align_torque = ctx.abs_speed * config.sat_base_torque_factor * std::abs(ctx.telemetry.steering);
+
+            if (ctx.speed_kmh > config.sat_speed_reduction_start) {
+                float speed_factor = 1.0f - ((ctx.speed_kmh - config.sat_speed_reduction_start) /
+                                             config.sat_speed_reduction_range);
+                ctx.self_align_torque *= std::max(config.sat_min_factor, speed_factor);
+            }
+
+            float lateral_factor = 1.0f - std::min(config.sat_max_lateral_reduction,
+                                                   std::abs(lateral_g) * config.sat_lateral_g_factor);
+            ctx.self_align_torque *= lateral_factor;
+        }
+    };
+
+    /// power steering assist, heavy steering with the engine off; looks up the steering curve for the speed
+    struct power_steering_stage {
+        static constexpr char const *name = "power steering";
+
+        constexpr bool active(force_context const &) const noexcept { return true; }
+
+        void apply(force_context &ctx) const noexcept {
+            ctx.steering = ctx.profile.steering_curve.at(std::abs(ctx.speed_kmh));
+            ctx.assisted = ctx.telemetry.engine_enabled && ctx.telemetry.rpm > 500.0f;
+            ctx.power_steering_multiplier = ctx.assisted ? ctx.steering[assist_engine_on]
+                                                         : ctx.steering[assist_engine_off];
+            ctx.centering_multiplier = ctx.assisted ? 0.7f : 1.0f;
+        }
+    };
+
+    /// base centering spring and damping from the steering curve
+    struct centering_stage {
+        static constexpr char const *name = "centering";
+
+        constexpr bool active(force_context const &) const noexcept { return true; }
+
+        void apply(force_context &ctx) const noexcept {
+            using enum force_channel;
+
+            force_mix &mix = ctx.mix;
+            steering_feel const feel = steering_feel_of(ctx.steering, ctx.self_align_torque, ctx.assisted,
+                                                        ctx.centering_multiplier);
+
+            mix[autocenter_force] = feel.autocenter_force;
+            mix[autocenter_slope] = feel.autocenter_slope;
+            mix[damper_pos] = feel.damper_pos;
+            mix[damper_neg] = feel.damper_neg;
+        }
+    };
+
+    /// engine brake and retarder stiffen the steering
+    struct brake_damping_stage {
+        static constexpr char const *name = "brake damping";
+
+        constexpr bool active(force_context const &ctx) const noexcept {
+            return ctx.telemetry.motor_brake || ctx.telemetry.retarder_level > 0;
+        }
+
+        void apply(force_context &ctx) const noexcept {
+            force_profile const &config = ctx.profile.values;
+
+            using enum force_channel;
+
+            force_mix &mix = ctx.mix;
+
+            float brake_factor = config.damper_brake_factor +
+                                 (ctx.telemetry.retarder_level * config.damper_retarder_factor);
+            if (ctx.telemetry.motor_brake) brake_factor += config.damper_engine_brake_factor;
+
+            mix[damper_pos] = std::min(config.damper_max_total, mix[damper_pos] * brake_factor);
+            mix[damper_neg] = std::min(config.damper_max_total, mix[damper_neg] * brake_factor);
+        }
+    };
+
+    /// understeer and oversteer from the yaw rate against the steering direction
+    struct yaw_stage {
+        static constexpr char const *name = "yaw";
+
+        constexpr bool active(force_context const &ctx) const noexcept {
+            return std::abs(ctx.telemetry.angular_velocity_z) > ctx.profile.values.yaw_rate_threshold &&
+                   ctx.abs_speed > 5.0f;
+        }
+
+        void apply(force_context &ctx) const noexcept {
+            force_profile const &config = ctx.profile.values;
+
+            using enum force_channel;
+
+            force_mix &mix = ctx.mix;
+
+            float const yaw_rate = ctx.telemetry.angular_velocity_z;
+            float const effective_steering = ctx.telemetry.steering;
+
+            // Add understeer/oversteer effects
+            float yaw_factor = std::min(config.yaw_max_factor, std::abs(yaw_rate) * config.yaw_rate_factor);
+
+            if ((yaw_rate > 0 && effective_steering > 0) || (yaw_rate < 0 && effective_steering < 0)) {
+                // Oversteer
+                mix[autocenter_force] *= 1.0f - yaw_factor * config.oversteer_reduction;
+                mix[damper_pos] += yaw_factor * config.oversteer_damping_add;
+                mix[damper_neg] += yaw_factor * config.oversteer_damping_add;
+            } else {
+                // Understeer
+                mix[autocenter_force] = std::min(
+                    80.0f, mix[autocenter_force] * (1.0f + yaw_factor * config.understeer_factor));
+            }
+        }
+    };
+
+    /// impacts, bumps and rough surfaces found by terrain detection
+    struct terrain_stage {
+        static constexpr char const *name = "terrain";
+
+        constexpr bool active(force_context const &ctx) const noexcept {
+            return ctx.terrain.impact_timer > 0.0f || (ctx.on_minor_bump && ctx.abs_speed > 12.0f) ||
+                   (ctx.on_rough_terrain && ctx.abs_speed > 8.0f);
+        }
+
+        void apply(force_context &ctx) const noexcept {
+            force_profile const &config = ctx.profile.values;
+
+            using enum force_channel;
+
+            force_mix &mix = ctx.mix;
+            terrain_state_t const &terrain = ctx.terrain;
+
+            float terrain_force_multiplier = 1.0f;
+            float terrain_damping_add = 0.0f;
+            float terrain_spring_intensity = 0.0f;
+
+            // Sudden impact effects (curbs, potholes, road edges)
+            if (terrain.impact_timer > 0.0f) {
+                float impact_intensity = terrain.impact_timer / (config.terrain_impact_duration * 0.3f);
+                terrain_force_multiplier += impact_intensity * 1.0f;
+                terrain_damping_add += impact_intensity * 2.0f;
+
+                terrain_spring_intensity = std::min(12.0f, impact_intensity * 20.0f);
+            }
+            // Minor bumps and surface variations
+            else if (ctx.on_minor_bump && ctx.abs_speed > 12.0f) {
+                terrain_force_multiplier += ctx.current_roughness * 1.0f;
+                terrain_damping_add += ctx.current_roughness * 0.8f;
+
+                terrain_spring_intensity = std::min(4.0f, 1.0f + ctx.current_roughness * 3.0f);
+            }
+            // Continuous rough terrain (dirt roads, gravel)
+            else {
+                if (ctx.on_major_terrain) {
+                    terrain_force_multiplier = 1.0f + config.terrain_offroad_multiplier * 0.1f;
+                    terrain_damping_add = terrain.smoothed_roughness * 0.8f;
+                } else {
+                    terrain_force_multiplier = 1.0f + terrain.smoothed_roughness * 0.5f;
+                    terrain_damping_add = terrain.smoothed_roughness * 0.4f;
+                }
+
+                terrain_spring_intensity = std::min(3.0f, 0.5f + terrain.smoothed_roughness * 2.0f);
+            }
+
+            if (terrain_force_multiplier > 1.0f || terrain_damping_add > 0.0f) {
+                mix[autocenter_force] = std::min(80.0f, mix[autocenter_force] * terrain_force_multiplier);
+                mix[damper_pos] = std::min(8.0f, mix[damper_pos] + terrain_damping_add);
+                mix[damper_neg] = std::min(8.0f, mix[damper_neg] + terrain_damping_add);
+            }
+
+            mix.use_custom_spring = true;
+            mix[spring_k1] = terrain_spring_intensity;
+            mix[spring_k2] = terrain_spring_intensity;
+            mix[spring_clip] = 20.0f + terrain_spring_intensity * 8.0f;
+        }
+    };
+
+    /// a sudden steering input pushes back for kickback_duration, skipped below kickback_speed_threshold
+    /// unless a kickback is still playing out
+    struct kickback_stage {
+        static constexpr char const *name = "kickback";
+
+        constexpr bool active(force_context const &ctx) const noexcept {
+            return ctx.terrain.kickback_timer > 0.0f || _triggered(ctx);
+        }
+
+        void apply(force_context &ctx) const noexcept {
+            force_profile const &config = ctx.profile.values;
+
+            force_mix &mix = ctx.mix;
+            terrain_state_t &terrain = ctx.terrain;
+
+            if (_triggered(ctx)) {
+                // Sudden steering inputs create momentary force feedback
+                terrain.kickback_timer = config.kickback_duration;
+                terrain.kickback_force = std::min(config.kickback_max_force,
+                                                  std::abs(ctx.telemetry.angular_acceleration_z) *
+                                                  config.kickback_factor);
+            }
+
+            if (terrain.kickback_timer > 0.0f) {
+                if (!mix.use_constant_force) {
+                    mix.use_constant_force = true;
+                    mix[force_channel::constant_force] = terrain.kickback_force;
+                }
+                terrain.kickback_timer = std::max(0.0f, terrain.kickback_timer - ctx.dt);
+            }
+        }
+
+    private:
+        static constexpr bool _triggered(force_context const &ctx) noexcept {
+            return ctx.new_frame && ctx.abs_speed > ctx.profile.values.kickback_speed_threshold &&
+                   std::abs(ctx.telemetry.angular_acceleration_z) > ctx.profile.values.kickback_threshold;
+        }
+    };
+
+    /// parking brake locks the steering, overrides everything before it
+    struct parking_brake_stage {
+        static constexpr char const *name = "parking brake";
+
+        constexpr bool active(force_context const &ctx) const noexcept { return ctx.telemetry.parking_brake; }
+
+        void apply(force_context &ctx) const noexcept {
+            force_profile const &config = ctx.profile.values;
+
+            using enum force_channel;
+
+            force_mix &mix = ctx.mix;
+
+            mix[autocenter_force] = config.parking_brake_force;
+            mix[autocenter_slope] = config.parking_brake_slope;
+            mix[damper_pos] = config.parking_brake_damper;
+            mix[damper_neg] = config.parking_brake_damper;
+        }
+    };
+
+    /// every stage of a force update, in the order they build on each other
+    using force_pipeline = effect_pipeline<force_context, terrain_detection_stage, self_align_stage,
+                                           power_steering_stage, centering_stage, brake_damping_stage, yaw_stage,
+                                           terrain_stage, kickback_stage, parking_brake_stage>;
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+#define G923MAC_HISTOGRAM_SUB_BUCKET_BITS 5 // 16 buckets per power of two above 32, ~6% relative error
+#define G923MAC_HISTOGRAM_MAX_VALUE_BITS  40 // values are clamped to 2^40 - 1 (~18 minutes in nanoseconds)
+
+namespace g923mac {
+    struct latency_summary {
+        std::uint64_t count;
+        std::uint64_t p50_ns;
+        std::uint64_t p99_ns;
+        std::uint64_t p999_ns;
+        std::uint64_t max_ns;
+    };
+
+    /// fixed-size log-linear histogram of nanosecond durations
+    /// values below 2^SubBits get a bucket each, above that every power of two is split into 2^(SubBits-1) buckets
+    /// recording is a few relaxed atomic adds, so any thread may record while another takes a summary
+    template<unsigned SubBits = G923MAC_HISTOGRAM_SUB_BUCKET_BITS, unsigned MaxBits = G923MAC_HISTOGRAM_MAX_VALUE_BITS>
+    class log_linear_histogram {
+        static_assert(SubBits >= 2 && SubBits < MaxBits && MaxBits < 64);
+
+    public:
+        static constexpr std::uint64_t max_value = (std::uint64_t{1} << MaxBits) - 1;
+        static constexpr std::size_t half_sub = std::size_t{1} << (SubBits - 1);
+        static constexpr std::size_t bucket_count = (MaxBits - SubBits + 2) * half_sub;
+
+        static constexpr std::size_t bucket_of(std::uint64_t value) noexcept {
+            if (value > max_value) value = max_value;
+
+            unsigned const width = static_cast<unsigned>(std::bit_width(value));
+            unsigned const shift = width > SubBits ? width - SubBits : 0;
+
+            return shift * half_sub + static_cast<std::size_t>(value >> shift);
+        }
+
+        /// largest value that lands in `bucket`
+        static constexpr std::uint64_t upper_bound(std::size_t bucket) noexcept {
+            if (bucket < 2 * half_sub) return bucket;
+
+            std::size_t const shift = bucket / half_sub - 1;
+            std::uint64_t const sub = bucket % half_sub + half_sub;
+
+            return ((sub + 1) << shift) - 1;
+        }
+
+        log_linear_histogram() noexcept = default;
+
+        log_linear_histogram(log_linear_histogram const &) = delete;
+        log_linear_histogram &operator=(log_linear_histogram const &) = delete;
+
+        void record(std::chrono::nanoseconds duration) noexcept {
+            std::uint64_t const value = duration.count() > 0 ? static_cast<std::uint64_t>(duration.count()) : 0;
+
+            buckets_[bucket_of(value)].fetch_add(1, std::memory_order_relaxed);
+            count_.fetch_add(1, std::memory_order_relaxed);
+
+            std::uint64_t max = max_.load(std::memory_order_relaxed);
+            while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+            }
+        }
+
+        std::uint64_t count() const noexcept { return count_.load(std::memory_order_relaxed); }
+
+        /// percentiles are bucket upper bounds, taken from a pass over buckets that may still be receiving records
+        latency_summary summary() const noexcept {
+            std::array<std::uint64_t, bucket_count> counts;
+            std::uint64_t total{0};
+
+            for (std::size_t i = 0; i < bucket_count; ++i) {
+                counts[i] = buckets_[i].load(std::memory_order_relaxed);
+                total += counts[i];
+            }
+
+            std::uint64_t const max = max_.load(std::memory_order_relaxed);
+
+            return latency_summary{
+                total,
+                _percentile(counts, total, 500, max),
+                _percentile(counts, total, 990, max),
+                _percentile(counts, total, 999, max),
+                max,
+            };
+        }
+
+        void reset() noexcept {
+            for (auto &bucket: buckets_) bucket.store(0, std::memory_order_relaxed);
+            count_.store(0, std::memory_order_relaxed);
+            max_.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        std::array<std::atomic<std::uint64_t>, bucket_count> buckets_{};
+        std::atomic<std::uint64_t> count_{0};
+        std::atomic<std::uint64_t> max_{0};
+
+        /// `per_mille` of the recorded values are at or below the result
+        static constexpr std::uint64_t _percentile(std::array<std::uint64_t, bucket_count> const &counts,
+                                                   std::uint64_t total, std::uint64_t per_mille,
+                                                   std::uint64_t max) noexcept {
+            if (total == 0) return 0;
+
+            std::uint64_t const rank = (total * per_mille + 999) / 1000;
+            std::uint64_t seen{0};
+
+            for (std::size_t i = 0; i < bucket_count; ++i) {
+                seen += counts[i];
+
+                if (seen >= rank) {
+                    std::uint64_t const bound = upper_bound(i);
+                    return bound < max ? bound : max;
+                }
+            }
+
+            return max;
+        }
+    };
+
+    static_assert(log_linear_histogram<>::bucket_of(31) == 31);
+    static_assert(log_linear_histogram<>::bucket_of(32) == 32);
+    static_assert(log_linear_histogram<>::upper_bound(log_linear_histogram<>::bucket_of(1000)) >= 1000);
+    static_assert(log_linear_histogram<>::bucket_of(log_linear_histogram<>::max_value) ==
+                  log_linear_histogram<>::bucket_count - 1);
+}
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <types.hpp>
+#include <device.hpp>
+#include <calibration.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+
+namespace g923mac {
+    /// what one take() applied to the active wheels
+    struct hotplug_changes {
+        std::size_t added;
+        std::size_t removed;
+
+        constexpr explicit operator bool() const noexcept { return added != 0 || removed != 0; }
+    };
+
+    /// watches the device manager for wheels coming and going while the game runs
+    /// arrivals are created and calibrated on the monitor thread, removals only record the device handle;
+    /// both wait in a mailbox until the force loop takes them, which never waits on the monitor
+    /// wheels taken out of the active set are handed back and destroyed here, so their writers are joined
+    /// off the force loop
+    template<typename T>
+    class hotplug_monitor {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        hotplug_monitor() noexcept = default;
+
+        hotplug_monitor(hotplug_monitor const &) = delete;
+        hotplug_monitor &operator=(hotplug_monitor const &) = delete;
+
+        ~hotplug_monitor() { stop(); }
+
+        bool running() const noexcept { return running_.load(std::memory_order_acquire); }
+
+        /// `make(hid_device const &) -> std::optional<T>` builds a wheel for an arrived device,
+        /// `calibrate(T &, calibration_options const &) -> bool` runs like it does at startup;
+        /// `attached` are the devices already handled, they are not treated as arrivals
+        template<typename Make, typename Calibrate>
+        void start(device_manager &devices, vector<hid_device> const &attached, clock::duration poll,
+                   bool led_sweep, clock::duration calibration_timeout, Make make, Calibrate calibrate) {
+            if (running()) return;
+
+            known_.clear();
+            for (auto const &device: attached) known_.push_back(_known(device));
+
+            running_.store(true, std::memory_order_release);
+            thread_ = std::thread([ this, &devices, poll, led_sweep, calibration_timeout, make, calibrate ]() mutable {
+                _run(devices, poll, led_sweep, calibration_timeout, make, calibrate);
+            });
+        }
+
+        /// cancels a calibration in progress; wheels not yet taken and wheels handed back are destroyed
+        void stop() {
+            if (!running()) return;
+
+            {
+                std::lock_guard lock{mutex_};
+                running_.store(false, std::memory_order_release);
+            }
+            wake_.notify_all();
+            thread_.join();
+
+            arrived_.clear();
+            removed_.clear();
+            retired_.clear();
+            pending_.store(false, std::memory_order_relaxed);
+        }
+
+        /// force loop side: moves arrived wheels into `wheels` and wheels whose device went away out of it,
+        /// `handle(T const &) -> hid_device_t const *` names the device a wheel drives
+        /// returns without changes when nothing is pending or the monitor holds the mailbox at that moment
+        template<typename Handle>
+        hotplug_changes take(vector<T> &wheels, Handle handle) {
+            if (!pending_.load(std::memory_order_acquire)) return {0, 0};
+
+            std::unique_lock lock{mutex_, std::try_to_lock};
+            if (!lock.owns_lock()) return {0, 0};
+
+            hotplug_changes changes{0, 0};
+
+            // arrivals first, a device replugged under the same handle retires the older wheel
+            for (T &wheel: arrived_) {
+                wheels.push_back(std::move(wheel));
+                ++changes.added;
+            }
+            arrived_.clear();
+
+            for (hid_device_t const *device: removed_) {
+                auto const gone = std::find_if(wheels.begin(), wheels.end(), [ & ](T const &wheel) {
+                    return handle(wheel) == device;
+                });
+                if (gone == wheels.end()) continue;
+
+                retired_.push_back(std::move(*gone));
+                wheels.erase(gone);
+                ++changes.removed;
+            }
+            removed_.clear();
+
+            pending_.store(false, std::memory_order_relaxed);
+            if (!retired_.empty()) wake_.notify_one();
+
+            return changes;
+        }
+
+    private:
+        std::thread thread_;
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::atomic<bool> running_{false};
+        std::atomic<bool> pending_{false};
+
+        /// one arrival of a device, a handle alone can come back for a replugged device
+        struct known_device {
+            hid_device_t const *handle;
+            std::uint64_t arrival;
+
+            constexpr bool operator==(known_device const &) const noexcept = default;
+        };
+
+        vector<known_device> known_; // monitor thread only
+
+        // guarded by mutex_
+        vector<T> arrived_;
+        vector<hid_device_t const *> removed_;
+        vector<T> retired_;
+
+        template<typename Make, typename Calibrate>
+        void _run(device_manager &devices, clock::duration poll, bool led_sweep,
+                  clock::duration calibration_timeout, Make &make, Calibrate &calibrate) {
+            while (running()) {
+                _release_retired();
+                _scan(devices, led_sweep, calibration_timeout, make, calibrate);
+
+                std::unique_lock lock{mutex_};
+                wake_.wait_for(lock, poll, [ this ] { return !running() || !retired_.empty(); });
+            }
+        }
+
+        void _release_retired() {
+            vector<T> retired;
+
+            {
+                std::lock_guard lock{mutex_};
+                retired.swap(retired_);
+            }
+            // destroyed outside the lock, each wheel joins its writer
+        }
+
+        template<typename Make, typename Calibrate>
+        void _scan(device_manager &devices, bool led_sweep, clock::duration calibration_timeout, Make &make,
+                   Calibrate &calibrate) {
+            vector<hid_device> const &attached = devices.list_devices();
+            vector<hid_device_t const *> removed;
+            vector<T> wheels;
+
+            for (auto it = known_.begin(); it != known_.end();) {
+                bool const present = std::any_of(attached.begin(), attached.end(), [ & ](hid_device const &device) {
+                    return _known(device) == *it;
+                });
+
+                if (present) {
+                    ++it;
+                    continue;
+                }
+                removed.push_back(it->handle);
+                it = known_.erase(it);
+            }
+
+            for (auto const &device: attached) {
+                if (std::find(known_.begin(), known_.end(), _known(device)) != known_.end()) continue;
+
+                // a device without a protocol or failing calibration stays known, it is not retried until replugged
+                known_.push_back(_known(device));
+
+                if (std::optional<T> wheel = make(device)) wheels.push_back(std::move(*wheel));
+            }
+
+            if (!removed.empty()) _post(vector<T>{}, std::move(removed));
+            if (!wheels.empty()) _calibrate(std::move(wheels), led_sweep, calibration_timeout, calibrate);
+        }
+
+        template<typename Calibrate>
+        void _calibrate(vector<T> &&wheels, bool led_sweep, clock::duration timeout, Calibrate &calibrate) {
+            constexpr std::chrono::milliseconds poll{10};
+
+            calibration_worker<T> worker;
+            vector<T> calibrated;
+
+            worker.start(std::move(wheels), led_sweep, timeout, calibrate, [ & ](vector<T> &&ready) {
+                calibrated = std::move(ready);
+            });
+
+            while (!worker.ready() && running()) std::this_thread::sleep_for(poll);
+
+            worker.stop();
+
+            if (worker.ready() && !calibrated.empty()) _post(std::move(calibrated), {});
+        }
+
+        static known_device _known(hid_device const &device) noexcept {
+            return known_device{device.hid_device_, transport::arrival(device.hid_device_)};
+        }
+
+        void _post(vector<T> &&arrived, vector<hid_device_t const *> &&removed) {
+            std::lock_guard lock{mutex_};
+
+            for (T &wheel: arrived) arrived_.push_back(std::move(wheel));
+            for (hid_device_t const *device: removed) removed_.push_back(device);
+
+            pending_.store(true, std::memory_order_release);
+        }
+    };
+}
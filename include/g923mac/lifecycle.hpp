@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+
+namespace g923mac {
+    enum class wheel_state : std::uint8_t {
+        uninitialized, // opened, nothing sent yet
+        calibrating, // running the startup sweep
+        active, // following the game
+        paused, // effects stopped and leds dark, sends nothing
+        faulted, // writes failing, still attempted so the wheel can come back
+        disconnected, // device gone, probed at a slow interval
+    };
+
+    constexpr char const *wheel_state_name(wheel_state state) noexcept {
+        switch (state) {
+            case wheel_state::uninitialized: return "uninitialized";
+            case wheel_state::calibrating: return "calibrating";
+            case wheel_state::active: return "active";
+            case wheel_state::paused: return "paused";
+            case wheel_state::faulted: return "faulted";
+            case wheel_state::disconnected: return "disconnected";
+            default: return "unknown";
+        }
+    }
+
+    /// transitions a wheel may take, staying in the same state is not a transition
+    constexpr bool can_transition(wheel_state from, wheel_state to) noexcept {
+        if (from == to) return false;
+
+        switch (from) {
+            case wheel_state::uninitialized:
+                return to == wheel_state::calibrating;
+            case wheel_state::calibrating:
+                return to == wheel_state::active || to == wheel_state::faulted || to == wheel_state::disconnected;
+            case wheel_state::active:
+            case wheel_state::paused:
+                return to == wheel_state::active || to == wheel_state::paused || to == wheel_state::faulted ||
+                       to == wheel_state::disconnected;
+            case wheel_state::faulted:
+            case wheel_state::disconnected:
+                return to != wheel_state::uninitialized;
+            default:
+                return false;
+        }
+    }
+
+    /// whether a wheel in `state` writes reports at all, disconnected wheels only on their probe interval
+    constexpr bool sends_reports(wheel_state state) noexcept {
+        return state == wheel_state::calibrating || state == wheel_state::active || state == wheel_state::faulted ||
+               state == wheel_state::disconnected;
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <scssdk.h>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+
+namespace g923mac {
+    /// log messages posted from worker threads, written to the game log by the game thread
+    /// the game's log callback may only be called from the thread the game calls the plugin on
+    /// bounded, a full queue drops the message and counts it
+    template<std::size_t Capacity = 16, std::size_t MessageLength = 512>
+    class log_queue {
+    public:
+        log_queue() noexcept = default;
+
+        log_queue(log_queue const &) = delete;
+        log_queue &operator=(log_queue const &) = delete;
+
+        /// any thread, `message` is copied and truncated to fit
+        void post(scs_log_type_t type, char const *message) noexcept {
+            std::lock_guard lock{mutex_};
+
+            if (count_ == Capacity) {
+                ++dropped_;
+                return;
+            }
+
+            entry &e = entries_[count_];
+            e.type = type;
+            std::snprintf(e.message, MessageLength, "%s", message);
+
+            ++count_;
+            pending_.store(true, std::memory_order_release);
+        }
+
+        /// game thread; hands every queued message to `log(type, message)`, cheap when nothing is queued
+        template<typename Log>
+        void drain(Log &&log) {
+            if (!pending_.load(std::memory_order_acquire)) return;
+
+            std::array<entry, Capacity> taken;
+            std::size_t count{0};
+            std::uint64_t dropped{0};
+
+            {
+                std::lock_guard lock{mutex_};
+
+                for (; count < count_; ++count) taken[count] = entries_[count];
+
+                count_ = 0;
+                dropped = dropped_;
+                dropped_ = 0;
+                pending_.store(false, std::memory_order_relaxed);
+            }
+
+            for (std::size_t i = 0; i < count; ++i) log(taken[i].type, taken[i].message);
+
+            if (dropped != 0) {
+                char message[128];
+                std::snprintf(message, sizeof(message), "g923mac::warning : %llu log message(s) dropped",
+                              static_cast<unsigned long long>(dropped));
+                log(SCS_LOG_TYPE_warning, message);
+            }
+        }
+
+    private:
+        struct entry {
+            scs_log_type_t type;
+            char message[MessageLength];
+        };
+
+        std::mutex mutex_;
+        std::array<entry, Capacity> entries_{};
+        std::size_t count_{0};
+        std::uint64_t dropped_{0};
+        std::atomic<bool> pending_{false};
+    };
+}
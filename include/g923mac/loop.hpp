@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <utility>
+
+namespace g923mac {
+    constexpr std::chrono::nanoseconds period_of(int hz) noexcept {
+        return std::chrono::nanoseconds(1'000'000'000 / (hz > 0 ? hz : 1));
+    }
+
+    /// calls a tick function on its own thread at a fixed period measured on the monotonic clock
+    /// ticks are scheduled against absolute deadlines so they do not drift,
+    /// a tick running past one or more deadlines skips them instead of bursting to catch up
+    /// the period may be changed while running, it applies from the next deadline
+    class fixed_rate_loop {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        fixed_rate_loop() noexcept = default;
+
+        fixed_rate_loop(fixed_rate_loop const &) = delete;
+        fixed_rate_loop &operator=(fixed_rate_loop const &) = delete;
+
+        ~fixed_rate_loop() { stop(); }
+
+        bool running() const noexcept { return running_.load(std::memory_order_acquire); }
+
+        std::uint64_t ticks() const noexcept { return ticks_.load(std::memory_order_relaxed); }
+
+        /// deadlines skipped because a tick ran too long
+        std::uint64_t overruns() const noexcept { return overruns_.load(std::memory_order_relaxed); }
+
+        clock::duration period() const noexcept { return clock::duration(period_.load(std::memory_order_relaxed)); }
+
+        void set_period(clock::duration period) noexcept { period_.store(period.count(), std::memory_order_relaxed); }
+
+        /// `tick(clock::time_point deadline)` runs once per period until stop()
+        template<typename Tick>
+        void start(clock::duration period, Tick &&tick) {
+            if (running()) return;
+
+            set_period(period);
+            running_.store(true, std::memory_order_release);
+            thread_ = std::thread([ this, tick = std::forward<Tick>(tick) ]() mutable {
+                _run(tick);
+            });
+        }
+
+        /// returns once the tick in progress, if any, has finished
+        void stop() {
+            if (!running()) return;
+
+            running_.store(false, std::memory_order_release);
+            thread_.join();
+        }
+
+    private:
+        std::thread thread_;
+        std::atomic<bool> running_{false};
+        std::atomic<std::uint64_t> ticks_{0};
+        std::atomic<std::uint64_t> overruns_{0};
+        std::atomic<clock::rep> period_{0};
+
+        template<typename Tick>
+        void _run(Tick &tick) {
+            clock::time_point deadline = clock::now();
+
+            while (running()) {
+                tick(deadline);
+                ticks_.fetch_add(1, std::memory_order_relaxed);
+
+                clock::duration const period = this->period();
+                deadline += period;
+
+                if (clock::time_point const now = clock::now(); now >= deadline) {
+                    auto const missed = (now - deadline) / period + 1;
+
+                    overruns_.fetch_add(static_cast<std::uint64_t>(missed), std::memory_order_relaxed);
+                    deadline += missed * period;
+                }
+
+                std::this_thread::sleep_until(deadline);
+            }
+        }
+    };
+}
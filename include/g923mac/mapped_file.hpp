@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace g923mac {
+    /// identifies one version of a file, any write or replacement changes it
+    struct file_stamp {
+        std::uint64_t inode;
+        std::uint64_t size;
+        std::uint64_t modified_ns;
+
+        constexpr bool operator==(file_stamp const &) const noexcept = default;
+    };
+
+    /// zero when the file does not exist
+    inline file_stamp stamp_of(char const *path) noexcept {
+        struct stat info{};
+        if (stat(path, &info) < 0) return file_stamp{0, 0, 0};
+
+#if defined(__APPLE__)
+        timespec const modified = info.st_mtimespec;
+#else
+        timespec const modified = info.st_mtim;
+#endif
+        return file_stamp{
+            static_cast<std::uint64_t>(info.st_ino), static_cast<std::uint64_t>(info.st_size),
+            static_cast<std::uint64_t>(modified.tv_sec) * 1'000'000'000u + static_cast<std::uint64_t>(modified.tv_nsec)
+        };
+    }
+
+    /// a read-only private mapping of a whole file, the descriptor is closed once mapped
+    /// empty or missing files map to an empty view
+    class mapped_file {
+    public:
+        constexpr mapped_file() noexcept = default;
+
+        explicit mapped_file(char const *path) noexcept {
+            int const fd = ::open(path, O_RDONLY | O_CLOEXEC);
+            if (fd < 0) return;
+
+            struct stat info{};
+            if (fstat(fd, &info) == 0 && info.st_size > 0) {
+                void *const data = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd,
+                                        0);
+
+                if (data != MAP_FAILED) {
+                    data_ = static_cast<char const *>(data);
+                    size_ = static_cast<std::size_t>(info.st_size);
+                }
+            }
+            ::close(fd);
+        }
+
+        mapped_file(mapped_file const &) = delete;
+        mapped_file &operator=(mapped_file const &) = delete;
+
+        mapped_file(mapped_file &&other) noexcept
+            : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {
+        }
+
+        mapped_file &operator=(mapped_file &&other) noexcept {
+            if (this != &other) {
+                _unmap();
+                data_ = std::exchange(other.data_, nullptr);
+                size_ = std::exchange(other.size_, 0);
+            }
+            return *this;
+        }
+
+        ~mapped_file() { _unmap(); }
+
+        constexpr bool mapped() const noexcept { return data_ != nullptr; }
+
+        constexpr std::string_view view() const noexcept { return std::string_view(data_, size_); }
+
+    private:
+        char const *data_{nullptr};
+        std::size_t size_{0};
+
+        void _unmap() noexcept {
+            if (data_ != nullptr) munmap(const_cast<char *>(data_), size_);
+            data_ = nullptr;
+            size_ = 0;
+        }
+    };
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace g923mac {
+    /// the numeric values of one force update, in the order they sit in force_mix and on the wire params
+    enum class force_channel : std::uint8_t {
+        autocenter_force,
+        autocenter_slope,
+        damper_pos,
+        damper_neg,
+        constant_force,
+        spring_k1,
+        spring_k2,
+        spring_clip,
+        count
+    };
+
+    constexpr std::size_t force_channel_count = static_cast<std::size_t>(force_channel::count);
+
+    /// largest wire value of each channel, every channel is a full byte except the custom spring coefficients,
+    /// which custom_spring packs into nibbles
+    constexpr std::array<float, force_channel_count> force_channel_limits{
+        255.0f, 255.0f, 255.0f, 255.0f, 255.0f, 15.0f, 15.0f, 255.0f
+    };
+
+    /// a force update while the effects are mixed, contributions accumulate at full precision
+    struct force_mix {
+        alignas(32) std::array<float, force_channel_count> channels{};
+        bool use_constant_force{false};
+        bool use_custom_spring{false};
+
+        constexpr float &operator[](force_channel channel) noexcept {
+            return channels[static_cast<std::size_t>(channel)];
+        }
+
+        constexpr float operator[](force_channel channel) const noexcept {
+            return channels[static_cast<std::size_t>(channel)];
+        }
+    };
+
+    /// what one force update asks of the wheel, in the wire units of the effects
+    struct force_feedback_params_t {
+        alignas(8) std::array<std::uint8_t, force_channel_count> channels;
+        bool use_constant_force;
+        bool use_custom_spring;
+
+        constexpr std::uint8_t operator[](force_channel channel) const noexcept {
+            return channels[static_cast<std::size_t>(channel)];
+        }
+    };
+
+    /// the one place a mix becomes wire values: every channel saturates to [0, limit] and truncates, NaN gives 0
+    /// the inner loop is branch-free over a fixed channel count, so it vectorizes across channels and wheels
+    constexpr void quantize(force_mix const *mixes, force_feedback_params_t *params, std::size_t count) noexcept {
+        for (std::size_t wheel = 0; wheel < count; ++wheel) {
+            for (std::size_t i = 0; i < force_channel_count; ++i) {
+                float const saturated = std::min(force_channel_limits[i], std::max(0.0f, mixes[wheel].channels[i]));
+                params[wheel].channels[i] = static_cast<std::uint8_t>(saturated);
+            }
+
+            params[wheel].use_constant_force = mixes[wheel].use_constant_force;
+            params[wheel].use_custom_spring = mixes[wheel].use_custom_spring;
+        }
+    }
+
+    constexpr force_feedback_params_t quantize(force_mix const &mix) noexcept {
+        force_feedback_params_t params{};
+        quantize(&mix, &params, 1);
+        return params;
+    }
+}
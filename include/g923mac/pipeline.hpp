@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+
+namespace g923mac {
+    /// cpu timestamp counter where there is one, otherwise monotonic nanoseconds
+    inline std::uint64_t read_cycles() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+        return __builtin_ia32_rdtsc();
+#else
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    /// one step of an effect pipeline: `active` is a cheap predicate, `apply` only runs when it holds
+    template<typename S, typename Context>
+    concept effect_stage = requires(S &stage, Context &context, Context const &view) {
+        { S::name } -> std::convertible_to<char const *>;
+        { stage.active(view) } -> std::same_as<bool>;
+        { stage.apply(context) } -> std::same_as<void>;
+    };
+
+    struct stage_stats {
+        std::uint64_t runs; // ticks the stage applied
+        std::uint64_t skips; // ticks its predicate turned it away
+        std::uint64_t cycles; // spent in the predicate and apply, over all ticks
+    };
+
+    /// runs its stages in order over one context per tick and accounts what each of them costs
+    /// stats are plain counters, read them from the thread that runs the pipeline or once it has stopped
+    template<typename Context, effect_stage<Context>... Stages>
+    class effect_pipeline {
+    public:
+        static constexpr std::size_t size = sizeof...(Stages);
+
+        static constexpr std::array<char const *, size> names{Stages::name...};
+
+        constexpr effect_pipeline() noexcept = default;
+
+        void run(Context &context) noexcept { _run(context, std::index_sequence_for<Stages...>{}); }
+
+        constexpr stage_stats const &stats(std::size_t index) const noexcept { return stats_[index]; }
+
+        constexpr std::uint64_t total_cycles() const noexcept {
+            std::uint64_t total{0};
+            for (auto const &stats: stats_) total += stats.cycles;
+            return total;
+        }
+
+        constexpr void reset_stats() noexcept { stats_ = {}; }
+
+    private:
+        std::tuple<Stages...> stages_;
+        std::array<stage_stats, size> stats_{};
+
+        template<std::size_t... Index>
+        void _run(Context &context, std::index_sequence<Index...>) noexcept {
+            (_step(std::get<Index>(stages_), stats_[Index], context), ...);
+        }
+
+        template<typename Stage>
+        static void _step(Stage &stage, stage_stats &stats, Context &context) noexcept {
+            std::uint64_t const start = read_cycles();
+
+            if (stage.active(std::as_const(context))) {
+                stage.apply(context);
+                ++stats.runs;
+            } else {
+                ++stats.skips;
+            }
+
+            stats.cycles += read_cycles() - start;
+        }
+    };
+}
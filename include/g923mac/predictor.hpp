@@ -0,0 +1,171 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#define G923MAC_PREDICTOR_WINDOW 4
+
+namespace g923mac {
+    /// the signals the predictor extrapolates, taken from one telemetry frame
+    struct motion_sample {
+        double time; // simulation time, seconds
+        float steering;
+        float yaw_rate; // angular_velocity_z
+        float yaw_accel; // angular_acceleration_z
+        float lateral_accel; // linear_acceleration_x
+    };
+
+    struct motion_state {
+        float steering;
+        float yaw_rate;
+        float lateral_accel;
+    };
+
+    /// extrapolates motion forward to cover the delay between the simulation step and the wheel reacting
+    /// yaw rate uses the reported yaw acceleration, steering and lateral acceleration have no reported derivative
+    /// so they use the least-squares slope over the last Window frames
+    template<std::size_t Window = G923MAC_PREDICTOR_WINDOW>
+    class motion_predictor {
+        static_assert(Window >= 2, "a slope needs two samples");
+
+    public:
+        constexpr void observe(motion_sample const &sample) noexcept {
+            samples_[next_] = sample;
+            next_ = (next_ + 1) % Window;
+            if (count_ < Window) ++count_;
+        }
+
+        constexpr void reset() noexcept { count_ = 0; next_ = 0; }
+
+        constexpr std::size_t size() const noexcept { return count_; }
+
+        /// state `lookahead` seconds after the latest sample, the latest sample unchanged when there is none to fit
+        constexpr motion_state predict(float lookahead) const noexcept {
+            if (count_ == 0) return motion_state{0.0f, 0.0f, 0.0f};
+
+            motion_sample const &latest = samples_[(next_ + Window - 1) % Window];
+
+            float const steering = latest.steering + _slope(&motion_sample::steering) * lookahead;
+
+            return motion_state{
+                steering < -1.0f ? -1.0f : (steering > 1.0f ? 1.0f : steering),
+                latest.yaw_rate + latest.yaw_accel * lookahead,
+                latest.lateral_accel + _slope(&motion_sample::lateral_accel) * lookahead,
+            };
+        }
+
+    private:
+        std::array<motion_sample, Window> samples_{};
+        std::size_t next_{0};
+        std::size_t count_{0};
+
+        constexpr float _slope(float motion_sample::*signal) const noexcept {
+            if (count_ < 2) return 0.0f;
+
+            double mean_t{0.0};
+            double mean_v{0.0};
+
+            for (std::size_t i = 0; i < count_; ++i) {
+                mean_t += samples_[i].time;
+                mean_v += samples_[i].*signal;
+            }
+            mean_t /= static_cast<double>(count_);
+            mean_v /= static_cast<double>(count_);
+
+            double covariance{0.0};
+            double variance{0.0};
+
+            for (std::size_t i = 0; i < count_; ++i) {
+                double const dt = samples_[i].time - mean_t;
+
+                covariance += dt * (samples_[i].*signal - mean_v);
+                variance += dt * dt;
+            }
+
+            return variance > 0.0 ? static_cast<float>(covariance / variance) : 0.0f;
+        }
+    };
+
+    struct prediction_error {
+        double rms;
+        double max;
+    };
+
+    /// prediction error per signal, next to the error of holding the last value (what the loop did before)
+    struct prediction_report {
+        std::size_t evaluated;
+        prediction_error steering;
+        prediction_error yaw_rate;
+        prediction_error lateral_accel;
+        prediction_error steering_hold;
+        prediction_error yaw_rate_hold;
+        prediction_error lateral_accel_hold;
+    };
+
+    /// replays recorded frames through a predictor and scores every prediction against the recorded value
+    /// `lookahead` seconds later, linearly interpolated between the frames around that time
+    template<std::size_t Window = G923MAC_PREDICTOR_WINDOW>
+    prediction_report evaluate_predictions(motion_sample const *samples, std::size_t count, float lookahead) noexcept {
+        struct accumulator {
+            double sum_sq{0.0};
+            double max{0.0};
+
+            void add(double error) noexcept {
+                sum_sq += error * error;
+                if (std::abs(error) > max) max = std::abs(error);
+            }
+
+            prediction_error result(std::size_t n) const noexcept {
+                return prediction_error{n ? std::sqrt(sum_sq / static_cast<double>(n)) : 0.0, max};
+            }
+        };
+
+        motion_predictor<Window> predictor;
+        accumulator steering, yaw_rate, lateral_accel;
+        accumulator steering_hold, yaw_rate_hold, lateral_accel_hold;
+        std::size_t evaluated{0};
+        std::size_t target{0};
+
+        for (std::size_t i = 0; i < count; ++i) {
+            predictor.observe(samples[i]);
+
+            double const at = samples[i].time + lookahead;
+
+            while (target + 1 < count && samples[target + 1].time < at) ++target;
+            if (target + 1 >= count) break;
+
+            motion_sample const &a = samples[target];
+            motion_sample const &b = samples[target + 1];
+            double const span = b.time - a.time;
+            double const w = span > 0.0 ? (at - a.time) / span : 0.0;
+
+            auto const actual = [ & ](float motion_sample::*signal) {
+                return a.*signal + (b.*signal - a.*signal) * w;
+            };
+
+            motion_state const predicted = predictor.predict(lookahead);
+
+            steering.add(predicted.steering - actual(&motion_sample::steering));
+            yaw_rate.add(predicted.yaw_rate - actual(&motion_sample::yaw_rate));
+            lateral_accel.add(predicted.lateral_accel - actual(&motion_sample::lateral_accel));
+
+            steering_hold.add(samples[i].steering - actual(&motion_sample::steering));
+            yaw_rate_hold.add(samples[i].yaw_rate - actual(&motion_sample::yaw_rate));
+            lateral_accel_hold.add(samples[i].lateral_accel - actual(&motion_sample::lateral_accel));
+
+            ++evaluated;
+        }
+
+        return prediction_report{
+            evaluated,
+            steering.result(evaluated),
+            yaw_rate.result(evaluated),
+            lateral_accel.result(evaluated),
+            steering_hold.result(evaluated),
+            yaw_rate_hold.result(evaluated),
+            lateral_accel_hold.result(evaluated),
+        };
+    }
+}
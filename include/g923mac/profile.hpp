@@ -0,0 +1,294 @@
+#pragma once
+
+#include <types.hpp>
+#include <curves.hpp>
+#include <mapped_file.hpp>
+#include <force_feedback_config.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+namespace g923mac {
+    /// a profile with everything derived from it, what the force loop reads
+    struct resolved_profile {
+        force_profile values;
+        steering_table steering_curve;
+
+        static constexpr resolved_profile resolve(force_profile const &values) noexcept {
+            return resolved_profile{values, make_steering_curve(values)};
+        }
+    };
+
+    /// ffb_config, in place whenever no profile file is
+    inline constexpr resolved_profile default_profile = resolved_profile::resolve(force_profile{});
+
+    struct profile_knob {
+        std::string_view name;
+        float force_profile::*value;
+    };
+
+    constexpr std::array profile_knobs{
+#define G923MAC_FORCE_PROFILE_KEY(name) profile_knob{#name, &force_profile::name},
+        G923MAC_FORCE_PROFILE_KNOBS(G923MAC_FORCE_PROFILE_KEY)
+#undef G923MAC_FORCE_PROFILE_KEY
+    };
+
+    enum class profile_error : std::uint8_t {
+        none,
+        missing, // no profile file, the defaults apply
+        bad_line, // a line that is not `knob = value`
+        unknown_knob,
+        bad_value, // not a decimal number
+    };
+
+    constexpr char const *profile_error_name(profile_error error) noexcept {
+        switch (error) {
+            case profile_error::none: return "none";
+            case profile_error::missing: return "missing";
+            case profile_error::bad_line: return "expected 'knob = value'";
+            case profile_error::unknown_knob: return "unknown knob";
+            case profile_error::bad_value: return "bad value";
+            default: return "unknown";
+        }
+    }
+
+    struct profile_parse_result {
+        profile_error error;
+        std::size_t line; // 1-based line of the error
+        std::size_t knobs; // knobs set
+    };
+
+    /// a decimal number with optional sign, fraction and exponent, the whole of `text`
+    constexpr bool parse_profile_value(std::string_view text, float &value) noexcept {
+        auto const digit = [ & ](std::size_t i) { return i < text.size() && text[i] >= '0' && text[i] <= '9'; };
+
+        std::size_t i{0};
+        bool const negative = i < text.size() && text[i] == '-';
+        if (i < text.size() && (text[i] == '-' || text[i] == '+')) ++i;
+
+        double number{0.0};
+        std::size_t digits{0};
+
+        for (; digit(i); ++i, ++digits) number = number * 10.0 + (text[i] - '0');
+
+        if (i < text.size() && text[i] == '.') {
+            double scale{0.1};
+            for (++i; digit(i); ++i, ++digits, scale *= 0.1) number += (text[i] - '0') * scale;
+        }
+        if (digits == 0) return false;
+
+        if (i < text.size() && (text[i] == 'e' || text[i] == 'E')) {
+            ++i;
+            bool const negative_exponent = i < text.size() && text[i] == '-';
+            if (i < text.size() && (text[i] == '-' || text[i] == '+')) ++i;
+            if (!digit(i)) return false;
+
+            int exponent{0};
+            for (; digit(i) && exponent < 100; ++i) exponent = exponent * 10 + (text[i] - '0');
+            if (exponent > 38) return false;
+
+            for (; exponent > 0; --exponent) number = negative_exponent ? number / 10.0 : number * 10.0;
+        }
+        if (i != text.size()) return false;
+
+        value = static_cast<float>(negative ? -number : number);
+        return true;
+    }
+
+    /// applies `knob = value` lines over `profile`, `#` starts a comment, blank lines are skipped
+    /// reads `text` in place; on an error `profile` is partly updated and should be dropped
+    constexpr profile_parse_result parse_profile(std::string_view text, force_profile &profile) noexcept {
+        constexpr std::string_view blank = " \t\r";
+
+        auto const trim = [ & ](std::string_view view) {
+            std::size_t const first = view.find_first_not_of(blank);
+            if (first == std::string_view::npos) return std::string_view{};
+
+            return view.substr(first, view.find_last_not_of(blank) - first + 1);
+        };
+
+        profile_parse_result result{profile_error::none, 0, 0};
+
+        while (!text.empty()) {
+            std::size_t const end = std::min(text.find('\n'), text.size());
+            std::string_view line = text.substr(0, end);
+            text.remove_prefix(std::min(end + 1, text.size()));
+            ++result.line;
+
+            line = trim(line.substr(0, line.find('#')));
+            if (line.empty()) continue;
+
+            std::size_t const equals = line.find('=');
+            if (equals == std::string_view::npos) return {profile_error::bad_line, result.line, result.knobs};
+
+            std::string_view const name = trim(line.substr(0, equals));
+            auto const knob = std::find_if(profile_knobs.begin(), profile_knobs.end(), [ & ](profile_knob const &k) {
+                return k.name == name;
+            });
+            if (knob == profile_knobs.end()) return {profile_error::unknown_knob, result.line, result.knobs};
+
+            if (!parse_profile_value(trim(line.substr(equals + 1)), profile.*(knob->value))) {
+                return {profile_error::bad_value, result.line, result.knobs};
+            }
+            ++result.knobs;
+        }
+        return result;
+    }
+
+    /// the profile the force loop uses, replaced with an atomic pointer swap
+    /// one reader (the force loop) and one writer at a time; the reader announces the profile it holds, so a replaced
+    /// profile is only freed once the reader has moved past it
+    class profile_store {
+    public:
+        profile_store() noexcept = default;
+
+        profile_store(profile_store const &) = delete;
+        profile_store &operator=(profile_store const &) = delete;
+
+        ~profile_store() {
+            _retire(current_.load(std::memory_order_relaxed));
+            for (resolved_profile const *profile: retired_) delete profile;
+        }
+
+        /// reader side, lock-free; the profile stays valid until the next acquire()
+        resolved_profile const &acquire() noexcept {
+            resolved_profile const *profile = current_.load(std::memory_order_acquire);
+
+            for (;;) {
+                held_.store(profile, std::memory_order_seq_cst);
+
+                resolved_profile const *const current = current_.load(std::memory_order_seq_cst);
+                if (current == profile) return *profile;
+
+                profile = current;
+            }
+        }
+
+        /// writer side, the reader picks `profile` up on its next acquire()
+        void publish(std::unique_ptr<resolved_profile> profile) {
+            _swap(profile.release());
+        }
+
+        /// resolves `values` first, the reader never waits on that
+        void load(force_profile const &values) {
+            publish(std::make_unique<resolved_profile>(resolved_profile::resolve(values)));
+        }
+
+        /// back to the defaults
+        void reset() { _swap(&default_profile); }
+
+    private:
+        std::atomic<resolved_profile const *> current_{&default_profile};
+        std::atomic<resolved_profile const *> held_{nullptr};
+        vector<resolved_profile const *> retired_; // writer only
+
+        void _swap(resolved_profile const *profile) {
+            _retire(current_.exchange(profile, std::memory_order_seq_cst));
+
+            resolved_profile const *const held = held_.load(std::memory_order_seq_cst);
+
+            std::erase_if(retired_, [ held ](resolved_profile const *retired) {
+                if (retired == held) return false;
+
+                delete retired;
+                return true;
+            });
+        }
+
+        void _retire(resolved_profile const *profile) {
+            if (profile != &default_profile) retired_.push_back(profile);
+        }
+    };
+
+    /// reloads a profile file on its own thread whenever the file changes and hands it to a sink, a profile_store
+    /// or anything else with `load(force_profile const &)` and `reset()`
+    /// a file that fails to parse leaves the previous profile in place, a removed file restores the defaults
+    class profile_watcher {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        profile_watcher() noexcept = default;
+
+        profile_watcher(profile_watcher const &) = delete;
+        profile_watcher &operator=(profile_watcher const &) = delete;
+
+        ~profile_watcher() { stop(); }
+
+        bool running() const noexcept { return running_.load(std::memory_order_acquire); }
+
+        /// loads the file once before returning, then checks it every `poll`
+        /// `report(profile_parse_result const &)` runs after every load attempt, on the loading thread
+        template<typename Sink, typename Report>
+        void start(std::string path, clock::duration poll, Sink &sink, Report report) {
+            if (running()) return;
+
+            path_ = std::move(path);
+            stamp_ = file_stamp{0, 0, 0};
+
+            _reload(sink, report, true);
+
+            running_.store(true, std::memory_order_release);
+            thread_ = std::thread([ this, poll, &sink, report ]() mutable {
+                while (_wait(poll)) _reload(sink, report, false);
+            });
+        }
+
+        void stop() {
+            if (!running()) return;
+
+            {
+                std::lock_guard lock{mutex_};
+                running_.store(false, std::memory_order_release);
+            }
+            wake_.notify_all();
+            thread_.join();
+        }
+
+        std::string const &path() const noexcept { return path_; }
+
+    private:
+        std::thread thread_;
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::atomic<bool> running_{false};
+
+        std::string path_;
+        file_stamp stamp_{0, 0, 0}; // of the file last loaded, watcher thread only once started
+
+        bool _wait(clock::duration poll) {
+            std::unique_lock lock{mutex_};
+            return !wake_.wait_for(lock, poll, [ this ] { return !running(); });
+        }
+
+        template<typename Sink, typename Report>
+        void _reload(Sink &sink, Report &report, bool initial) {
+            file_stamp const stamp = stamp_of(path_.c_str());
+
+            if (stamp == stamp_ && !initial) return;
+            stamp_ = stamp;
+
+            if (stamp == file_stamp{0, 0, 0}) {
+                sink.reset();
+                report(profile_parse_result{profile_error::missing, 0, 0});
+                return;
+            }
+
+            mapped_file const file{path_.c_str()};
+            force_profile values{};
+            profile_parse_result const result = parse_profile(file.view(), values);
+
+            if (result.error == profile_error::none) sink.load(values);
+            report(result);
+        }
+    };
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <types.hpp>
+#include <command.hpp>
+#include <effects.hpp>
+#include <concepts>
+#include <cstdint>
+
+#define G923_DEV_ID 0xc266046d
+
+namespace g923mac {
+    /// what a wheel protocol provides: the device it drives and a constexpr encoder per command
+    template<typename P>
+    concept wheel_protocol = requires(std::uint8_t v) {
+        { P::device_id } -> std::convertible_to<device_id_t>;
+        { P::disable_autocenter() } -> std::same_as<report>;
+        { P::enable_autocenter() } -> std::same_as<report>;
+        { P::autocenter_spring(v, v, v) } -> std::same_as<report>;
+        { P::custom_spring(v, v, v, v, v, v, v) } -> std::same_as<report>;
+        { P::constant_force(v) } -> std::same_as<report>;
+        { P::damper(v, v, v, v) } -> std::same_as<report>;
+        { P::trapezoid(v, v, v, v, v, v) } -> std::same_as<report>;
+        { P::stop_slots(v) } -> std::same_as<report>;
+        { P::stop_forces() } -> std::same_as<report>;
+        { P::led_pattern(v) } -> std::same_as<report>;
+    };
+
+    /// logitech classic ffb protocol as spoken by the G923 (playstation / pc)
+    /// every effect type is downloaded to a slot of its own, so a stop can leave the other effects playing
+    struct g923_protocol {
+        static constexpr device_id_t device_id = G923_DEV_ID;
+
+        static constexpr report disable_autocenter() noexcept {
+            return report{{0xF5}};
+        }
+
+        static constexpr report enable_autocenter() noexcept {
+            return report{{0xF4}};
+        }
+
+        static constexpr report autocenter_spring(std::uint8_t k1, std::uint8_t k2, std::uint8_t clip) noexcept {
+            return report{{0xFE, 0x00, k1, k2, clip, 0x00}};
+        }
+
+        static constexpr report custom_spring(std::uint8_t d1, std::uint8_t d2, std::uint8_t k1, std::uint8_t k2,
+                                              std::uint8_t s1, std::uint8_t s2, std::uint8_t clip) noexcept {
+            return report{{_download(effect_slot::spring), 0x01, d1, d2, _nibbles(k2, k1), _nibbles(s2, s1), clip}};
+        }
+
+        static constexpr report constant_force(std::uint8_t force_level) noexcept {
+            return report{{_download(effect_slot::constant), 0x00, force_level, force_level, force_level, force_level, 0x00}};
+        }
+
+        static constexpr report damper(std::uint8_t k1, std::uint8_t k2, std::uint8_t s1, std::uint8_t s2) noexcept {
+            return report{{_download(effect_slot::damper), 0x02, k1, s1, k2, s2, 0x00}};
+        }
+
+        static constexpr report trapezoid(std::uint8_t l1, std::uint8_t l2, std::uint8_t t1, std::uint8_t t2,
+                                          std::uint8_t t3, std::uint8_t s) noexcept {
+            return report{{_download(effect_slot::trapezoid), 0x06, l1, l2, t1, t2, _nibbles(t3, s)}};
+        }
+
+        /// `slots` is a mask of device slots, see effect_slot_bit
+        static constexpr report stop_slots(std::uint8_t slots) noexcept {
+            return report{{_nibbles(slots, 0x03), 0x00}};
+        }
+
+        static constexpr report stop_forces() noexcept {
+            return stop_slots(0x0F);
+        }
+
+        static constexpr report led_pattern(std::uint8_t pattern) noexcept {
+            return report{{0xF8, 0x12, pattern}};
+        }
+
+    private:
+        static constexpr std::uint8_t _download(effect_slot type) noexcept {
+            return _nibbles(effect_slot_bit(static_cast<std::uint8_t>(type)), 0x01);
+        }
+
+        static constexpr std::uint8_t _nibbles(std::uint8_t high, std::uint8_t low) noexcept {
+            return static_cast<std::uint8_t>((high << 4) | low);
+        }
+    };
+
+    static_assert(wheel_protocol<g923_protocol>);
+}
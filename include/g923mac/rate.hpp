@@ -0,0 +1,102 @@
+#pragma once
+
+#include <force_feedback_config.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace g923mac {
+    /// why the controller last changed the force rate
+    enum class rate_reason : std::uint8_t {
+        write_latency, // device writes took longer than the high mark, backed off
+        backlog, // reports piled up in front of the device, backed off
+        recovered, // transport kept up for a whole window, sped up
+        count
+    };
+
+    constexpr char const *rate_reason_name(rate_reason reason) noexcept {
+        switch (reason) {
+            case rate_reason::write_latency: return "write latency";
+            case rate_reason::backlog: return "backlog";
+            case rate_reason::recovered: return "recovered";
+            default: return "unknown";
+        }
+    }
+
+    /// what the transport did over one window, across all wheels
+    struct backpressure_sample {
+        std::chrono::nanoseconds write_latency; // mean time per device write
+        std::size_t backlog; // reports waiting to be written, deepest wheel
+    };
+
+    /// adapts the force tick rate and the write spacing to what the usb transport sustains
+    /// backs off multiplicatively while writes are slow or reports queue up, creeps back additively once
+    /// the transport keeps up; a wider write spacing lets the scheduler coalesce more reports per write
+    class rate_controller {
+    public:
+        using config = ffb_config;
+
+        /// the configured rate, what the controller starts at and recovers to; max_hz only caps it
+        static constexpr int target_hz = std::min(config::force_update_hz, config::force_update_max_hz);
+
+        constexpr rate_controller() noexcept = default;
+
+        constexpr int rate_hz() const noexcept { return rate_hz_; }
+
+        constexpr std::chrono::microseconds write_interval() const noexcept { return write_interval_; }
+
+        constexpr std::uint64_t adjustments(rate_reason reason) const noexcept {
+            return adjustments_[static_cast<std::size_t>(reason)];
+        }
+
+        /// true when the rate or write interval changed, `reason` says why
+        constexpr bool update(backpressure_sample const &sample, rate_reason &reason) noexcept {
+            auto const latency = std::chrono::duration_cast<std::chrono::microseconds>(sample.write_latency);
+
+            if (latency.count() > config::backpressure_latency_high_us) {
+                reason = rate_reason::write_latency;
+                return _back_off(reason);
+            }
+            if (sample.backlog > config::backpressure_backlog_high) {
+                reason = rate_reason::backlog;
+                return _back_off(reason);
+            }
+            if (latency.count() < config::backpressure_latency_low_us &&
+                sample.backlog <= config::backpressure_backlog_low) {
+                reason = rate_reason::recovered;
+                return _recover(reason);
+            }
+
+            return false;
+        }
+
+    private:
+        int rate_hz_{target_hz};
+        std::chrono::microseconds write_interval_{config::report_interval_us};
+        std::array<std::uint64_t, static_cast<std::size_t>(rate_reason::count)> adjustments_{};
+
+        constexpr bool _apply(int rate_hz, std::chrono::microseconds write_interval, rate_reason reason) noexcept {
+            if (rate_hz == rate_hz_ && write_interval == write_interval_) return false;
+
+            rate_hz_ = rate_hz;
+            write_interval_ = write_interval;
+            ++adjustments_[static_cast<std::size_t>(reason)];
+
+            return true;
+        }
+
+        constexpr bool _back_off(rate_reason reason) noexcept {
+            return _apply(std::max(config::force_update_min_hz, rate_hz_ * 3 / 4),
+                          std::min(std::chrono::microseconds(config::report_interval_max_us), write_interval_ * 2),
+                          reason);
+        }
+
+        constexpr bool _recover(rate_reason reason) noexcept {
+            return _apply(std::min(target_hz, rate_hz_ + config::force_update_step_hz),
+                          std::max(std::chrono::microseconds(config::report_interval_us), write_interval_ / 2),
+                          reason);
+        }
+    };
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <types.hpp>
+#include <command.hpp>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+
+#define G923MAC_RING_CAPACITY 64
+
+namespace g923mac {
+    enum class overflow_policy {
+        drop_newest, // full ring rejects the new report
+        drop_oldest, // full ring discards the oldest pending report
+        latest_wins, // a new report supersedes pending reports with the same command key, full ring drops oldest
+    };
+
+    enum class push_result {
+        stored,
+        replaced_oldest,
+        rejected,
+    };
+
+    /// bounded single-producer / single-consumer queue of reports
+    /// slots hold reports packed into 64-bit words so the producer may retire pending entries
+    /// (drop-oldest, latest-wins) without racing the consumer; a zero word marks a retired slot
+    template<std::size_t Capacity = G923MAC_RING_CAPACITY>
+    class report_ring {
+        static_assert(std::has_single_bit(Capacity), "ring capacity must be a power of two");
+        static_assert(sizeof(report) == sizeof(std::uint64_t), "report must pack into a single word");
+
+    public:
+        report_ring() noexcept {
+            for (auto &slot: slots_) slot.store(retired, std::memory_order_relaxed);
+        }
+
+        report_ring(report_ring const &) = delete;
+        report_ring &operator=(report_ring const &) = delete;
+
+        static constexpr std::size_t capacity() noexcept { return Capacity; }
+
+        std::size_t size() const noexcept {
+            return static_cast<std::size_t>(head_.load(std::memory_order_acquire) -
+                                            tail_.load(std::memory_order_acquire));
+        }
+
+        bool empty() const noexcept { return size() == 0; }
+
+        /// producer side; `coalesced` counts pending reports superseded under latest_wins
+        push_result push(report const &rep, overflow_policy policy, std::uint32_t &coalesced) noexcept {
+            std::uint64_t const word = _pack(rep);
+            std::uint64_t const head = head_.load(std::memory_order_relaxed);
+            std::uint64_t tail = tail_.load(std::memory_order_acquire);
+
+            if (policy == overflow_policy::latest_wins) {
+                std::uint16_t const key = command_key(rep);
+
+                for (std::uint64_t i = tail; i < head; ++i) {
+                    std::uint64_t pending = slots_[i & mask].load(std::memory_order_relaxed);
+
+                    if (pending != retired && command_key(_unpack(pending)) == key &&
+                        slots_[i & mask].compare_exchange_strong(pending, retired, std::memory_order_relaxed)) {
+                        ++coalesced;
+                    }
+                }
+            }
+
+            push_result result = push_result::stored;
+
+            if (head - tail == Capacity) {
+                if (policy == overflow_policy::drop_newest) return push_result::rejected;
+
+                // a failed exchange means the consumer took the oldest slot itself, leaving room
+                if (tail_.compare_exchange_strong(tail, tail + 1, std::memory_order_acq_rel)) {
+                    result = push_result::replaced_oldest;
+                }
+            }
+
+            slots_[head & mask].store(word, std::memory_order_relaxed);
+            head_.store(head + 1, std::memory_order_release);
+
+            return result;
+        }
+
+        /// consumer side
+        bool pop(report &rep) noexcept {
+            std::uint64_t tail = tail_.load(std::memory_order_acquire);
+
+            while (tail != head_.load(std::memory_order_acquire)) {
+                std::uint64_t const word = slots_[tail & mask].load(std::memory_order_relaxed);
+
+                if (tail_.compare_exchange_weak(tail, tail + 1, std::memory_order_acq_rel)) {
+                    if (word == retired) {
+                        ++tail;
+                        continue;
+                    }
+                    rep = _unpack(word);
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+    private:
+        static constexpr std::uint64_t mask = Capacity - 1;
+        static constexpr std::uint64_t retired = 0;
+
+        alignas(64) std::atomic<std::uint64_t> head_{0};
+        alignas(64) std::atomic<std::uint64_t> tail_{0};
+        alignas(64) std::array<std::atomic<std::uint64_t>, Capacity> slots_;
+
+        static constexpr std::uint64_t _pack(report const &rep) noexcept { return std::bit_cast<std::uint64_t>(rep); }
+        static constexpr report _unpack(std::uint64_t word) noexcept { return std::bit_cast<report>(word); }
+    };
+}
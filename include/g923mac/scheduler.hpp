@@ -0,0 +1,135 @@
+#pragma once
+
+#include <types.hpp>
+#include <command.hpp>
+#include <force_feedback_config.hpp>
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace g923mac {
+    /// write order of pending reports, lower goes out first
+    enum class report_priority : std::uint8_t {
+        safety, // stop
+        force, // constant force and kickback
+        condition, // spring, damper and autocenter
+        leds,
+        count
+    };
+
+    constexpr report_priority priority_of(command_slot slot) noexcept {
+        switch (slot) {
+            case command_slot::stop: return report_priority::safety;
+            case command_slot::constant:
+            case command_slot::trapezoid: return report_priority::force;
+            case command_slot::leds: return report_priority::leds;
+            default: return report_priority::condition;
+        }
+    }
+
+    /// reports pending for one device, one per command slot
+    /// the most urgent pending report is written first, at most one per report interval,
+    /// so a force change never waits behind more than one write
+    class report_scheduler {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        constexpr report_scheduler() noexcept
+            : report_scheduler(std::chrono::microseconds(ffb_config::report_interval_us)) {
+        }
+
+        constexpr explicit report_scheduler(clock::duration interval) noexcept : interval_(interval) {
+        }
+
+        constexpr bool empty() const noexcept { return pending_ == 0; }
+
+        constexpr std::size_t size() const noexcept { return pending_; }
+
+        constexpr clock::duration interval() const noexcept { return interval_; }
+
+        /// a longer interval lets more reports coalesce between writes
+        constexpr void set_interval(clock::duration interval) noexcept { interval_ = interval; }
+
+        /// earliest time the next report may be written
+        constexpr clock::time_point ready_at() const noexcept { return last_write_ + interval_; }
+
+        /// a report replaces the pending one for its slot, a stop discards pending downloads it would cancel
+        /// returns false for reports without a slot, those are not scheduled
+        constexpr bool add(report const &rep, std::uint32_t &coalesced) noexcept {
+            command_slot const slot = slot_of(rep);
+
+            if (slot == command_slot::count) return false;
+
+            if (slot == command_slot::stop) {
+                coalesced += _discard(command_slot::constant);
+                coalesced += _discard(command_slot::spring);
+                coalesced += _discard(command_slot::damper);
+                coalesced += _discard(command_slot::trapezoid);
+            }
+
+            entry &e = _at(slot);
+
+            if (e.valid) {
+                ++coalesced;
+            } else {
+                ++pending_;
+            }
+            e = entry{rep, sequence_++, true};
+
+            return true;
+        }
+
+        /// takes the most urgent report, oldest first within a priority, and starts the next interval at `now`
+        constexpr bool pop(report &rep, clock::time_point now) noexcept {
+            entry *next = nullptr;
+
+            for (auto &e: entries_) {
+                if (!e.valid) continue;
+
+                if (next == nullptr || _before(e, *next)) next = &e;
+            }
+
+            if (next == nullptr) return false;
+
+            rep = next->rep;
+            next->valid = false;
+            --pending_;
+            last_write_ = now;
+
+            return true;
+        }
+
+    private:
+        struct entry {
+            report rep;
+            std::uint64_t sequence;
+            bool valid;
+        };
+
+        std::array<entry, command_slot_count> entries_{};
+        std::size_t pending_{0};
+        std::uint64_t sequence_{0};
+        clock::duration interval_;
+        clock::time_point last_write_{};
+
+        constexpr entry &_at(command_slot slot) noexcept { return entries_[static_cast<std::size_t>(slot)]; }
+
+        constexpr std::uint32_t _discard(command_slot slot) noexcept {
+            entry &e = _at(slot);
+
+            if (!e.valid) return 0;
+
+            e.valid = false;
+            --pending_;
+            return 1;
+        }
+
+        constexpr bool _before(entry const &lhs, entry const &rhs) const noexcept {
+            report_priority const lhs_priority = priority_of(slot_of(lhs.rep));
+            report_priority const rhs_priority = priority_of(slot_of(rhs.rep));
+
+            if (lhs_priority != rhs_priority) return lhs_priority < rhs_priority;
+            return lhs.sequence < rhs.sequence;
+        }
+    };
+}
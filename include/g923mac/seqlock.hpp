@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+namespace g923mac {
+    /// latest published value of a trivially copyable T, one writer thread and any number of lock-free readers
+    /// the writer fills the buffer readers are not pointed at, then flips `current_` to it;
+    /// each buffer carries its own sequence (odd while being written) so a reader that raced a second publish
+    /// notices and copies again. values are held as atomic words, a torn read is detected, never undefined
+    template<typename T>
+    class seqlock_snapshot {
+        static_assert(std::is_trivially_copyable_v<T>, "snapshots are copied word by word");
+
+    public:
+        seqlock_snapshot() noexcept {
+            for (auto &buffer: buffers_) {
+                for (auto &word: buffer.words) word.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        seqlock_snapshot(seqlock_snapshot const &) = delete;
+        seqlock_snapshot &operator=(seqlock_snapshot const &) = delete;
+
+        /// number of values published so far, readers can compare it to skip a frame they already saw
+        std::uint64_t version() const noexcept { return published_.load(std::memory_order_acquire); }
+
+        /// writer side
+        void publish(T const &value) noexcept {
+            std::array<std::uint64_t, word_count> words{};
+            std::memcpy(words.data(), &value, sizeof(T));
+
+            std::size_t const target = current_.load(std::memory_order_relaxed) ^ 1;
+            buffer &b = buffers_[target];
+            std::uint64_t const sequence = b.sequence.load(std::memory_order_relaxed);
+
+            b.sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            for (std::size_t i = 0; i < word_count; ++i) b.words[i].store(words[i], std::memory_order_relaxed);
+
+            b.sequence.store(sequence + 2, std::memory_order_release);
+            current_.store(target, std::memory_order_release);
+            published_.fetch_add(1, std::memory_order_release);
+        }
+
+        /// reader side, any thread
+        T load() const noexcept {
+            std::array<std::uint64_t, word_count> words{};
+
+            for (;;) {
+                buffer const &b = buffers_[current_.load(std::memory_order_acquire)];
+                std::uint64_t const before = b.sequence.load(std::memory_order_acquire);
+
+                if (before & 1) continue;
+
+                for (std::size_t i = 0; i < word_count; ++i) words[i] = b.words[i].load(std::memory_order_relaxed);
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+
+                if (b.sequence.load(std::memory_order_relaxed) == before) break;
+            }
+
+            T value;
+            std::memcpy(&value, words.data(), sizeof(T));
+            return value;
+        }
+
+    private:
+        static constexpr std::size_t word_count = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+        struct buffer {
+            alignas(64) std::atomic<std::uint64_t> sequence{0};
+            std::array<std::atomic<std::uint64_t>, word_count> words;
+        };
+
+        std::array<buffer, 2> buffers_;
+        alignas(64) std::atomic<std::size_t> current_{0};
+        std::atomic<std::uint64_t> published_{0};
+    };
+}
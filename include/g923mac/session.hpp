@@ -0,0 +1,117 @@
+#pragma once
+
+#include <util.hpp>
+#include <types.hpp>
+#include <command.hpp>
+#include <device.hpp>
+#include <utility>
+
+namespace g923mac {
+    /// owns an open (seized) handle on a hid device for as long as it lives
+    /// reports go straight to the device, failing sends with a stale handle reopen it once and retry
+    class device_session {
+    public:
+        constexpr device_session() noexcept : device_{0, 0, 0, nullptr} {
+        }
+
+        explicit device_session(hid_device const &device) noexcept : device_(device) {
+            open();
+        }
+
+        device_session(device_session const &) = delete;
+        device_session &operator=(device_session const &) = delete;
+
+        constexpr device_session(device_session &&other) noexcept
+            : device_(other.device_),
+              open_(std::exchange(other.open_, false)),
+              reopen_count_(other.reopen_count_) {
+        }
+
+        device_session &operator=(device_session &&other) noexcept {
+            if (this != &other) {
+                close();
+
+                device_ = other.device_;
+                open_ = std::exchange(other.open_, false);
+                reopen_count_ = other.reopen_count_;
+            }
+            return *this;
+        }
+
+        ~device_session() { close(); }
+
+        constexpr hid_device const &device() const noexcept { return device_; }
+
+        constexpr bool is_open() const noexcept { return open_; }
+
+        constexpr std::uint32_t reopen_count() const noexcept { return reopen_count_; }
+
+        io_result_t open() noexcept {
+            if (open_) return io_success;
+            if (device_.hid_device_ == nullptr) return io_no_device;
+
+            io_result_t result = open_device(device_);
+            open_ = (result == io_success);
+
+            return result;
+        }
+
+        void close() noexcept {
+            if (!open_) return;
+
+            close_device(device_);
+            open_ = false;
+        }
+
+        io_result_t reopen() noexcept {
+            close();
+            ++reopen_count_;
+            print_info("reopening device session...");
+
+            return open();
+        }
+
+        io_result_t send(report const &rep) noexcept {
+            if (!open_) {
+                io_result_t result = open();
+                if (result != io_success) return result;
+            }
+
+            io_result_t result = send_report(device_, rep);
+
+            if (_is_stale(result) && reopen() == io_success) {
+                result = send_report(device_, rep);
+            }
+
+            return result;
+        }
+
+        /// stops at the first failing report, a stale handle is reopened once for the whole batch
+        template<std::size_t Capacity>
+        io_result_t send(report_batch<Capacity> const &batch) noexcept {
+            if (batch.empty()) return io_success;
+
+            if (!open_) {
+                io_result_t result = open();
+                if (result != io_success) return result;
+            }
+
+            io_result_t result = send_report(device_, batch);
+
+            if (_is_stale(result) && reopen() == io_success) {
+                result = send_report(device_, batch);
+            }
+
+            return result;
+        }
+
+    private:
+        hid_device device_;
+        bool open_{false};
+        std::uint32_t reopen_count_{0};
+
+        static constexpr bool _is_stale(io_result_t result) noexcept {
+            return result == io_not_open || result == io_no_device;
+        }
+    };
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <types.hpp>
+#include <command.hpp>
+#include <force_feedback_config.hpp>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <initializer_list>
+
+namespace g923mac {
+    /// last report sent per command family and effect slot
+    /// a report identical to the one the device already holds is skipped, unless it is older than the refresh interval
+    class report_shadow {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        constexpr report_shadow() noexcept
+            : report_shadow(std::chrono::milliseconds(ffb_config::shadow_refresh_interval_ms)) {
+        }
+
+        /// a zero refresh interval never forces a resend
+        constexpr explicit report_shadow(clock::duration refresh_interval) noexcept
+            : refresh_interval_(refresh_interval) {
+        }
+
+        constexpr std::uint64_t suppressed() const noexcept { return suppressed_; }
+
+        constexpr bool should_send(report const &rep, clock::time_point now) noexcept {
+            entry const *e = _find(rep);
+
+            if (e == nullptr || !e->valid) return true;
+            if (std::memcmp(e->rep.cmd, rep.cmd, G923MAC_CMD_MAX_LEN) != 0) return true;
+            if (refresh_interval_ != clock::duration::zero() && now - e->sent >= refresh_interval_) return true;
+
+            ++suppressed_;
+            return false;
+        }
+
+        constexpr void commit(report const &rep, clock::time_point now) noexcept {
+            entry *e = _find(rep);
+
+            if (e == nullptr) return;
+
+            *e = entry{rep, now, true};
+
+            switch (opcode_of(rep)) {
+                case 0xF1:
+                    // a new download arms the device again, a following stop is no longer redundant
+                    _at(command_slot::stop).valid = false;
+                    break ;
+                case 0xF3:
+                    // stopped effects have to be downloaded again, the ones in other slots keep playing
+                    for (command_slot const slot: {command_slot::constant, command_slot::spring,
+                                                   command_slot::damper, command_slot::trapezoid}) {
+                        if (slot_mask_of(_at(slot).rep) & slot_mask_of(rep)) _at(slot).valid = false;
+                    }
+                    break ;
+                case 0xF5:
+                    // resend the spring parameters along with the next enable
+                    _at(command_slot::autocenter_spring).valid = false;
+                    break ;
+                default:
+                    break ;
+            }
+        }
+
+        constexpr void invalidate() noexcept {
+            for (auto &e: entries_) e.valid = false;
+        }
+
+    private:
+        struct entry {
+            report rep;
+            clock::time_point sent;
+            bool valid;
+        };
+
+        std::array<entry, command_slot_count> entries_{};
+        clock::duration refresh_interval_;
+        std::uint64_t suppressed_{0};
+
+        constexpr entry &_at(command_slot slot) noexcept { return entries_[static_cast<std::size_t>(slot)]; }
+
+        constexpr entry *_find(report const &rep) noexcept {
+            command_slot const slot = slot_of(rep);
+
+            return slot == command_slot::count ? nullptr : &_at(slot);
+        }
+    };
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <seqlock.hpp>
+#include <scssdk.h>
+#include <cstdint>
+
+namespace g923mac {
+    /// channel values of one game frame, filled field by field by the telemetry callbacks
+    struct telemetry_state_t {
+        scs_timestamp_t timestamp;
+        scs_timestamp_t raw_rendering_timestamp;
+        scs_timestamp_t raw_simulation_timestamp;
+        scs_timestamp_t raw_paused_simulation_timestamp;
+
+        bool orientation_available;
+
+        float heading;
+        float pitch;
+        float roll;
+
+        float steering;
+        float input_steering;
+        float throttle;
+        float brake;
+        float clutch;
+
+        float speed;
+        float rpm;
+        int gear;
+
+        float linear_velocity_x; // lateral velocity
+        float linear_velocity_y; // vertical velocity
+        float linear_velocity_z; // longitudinal velocity
+        float angular_velocity_x; // roll rate
+        float angular_velocity_y; // pitch rate
+        float angular_velocity_z; // yaw rate
+        float linear_acceleration_x; // lateral acceleration
+        float linear_acceleration_y; // vertical acceleration
+        float linear_acceleration_z; // longitudinal acceleration
+        float angular_acceleration_x; // roll acceleration
+        float angular_acceleration_y; // pitch acceleration
+        float angular_acceleration_z; // yaw acceleration
+
+        bool parking_brake;
+        bool motor_brake;
+        std::uint32_t retarder_level;
+        float brake_air_pressure;
+        float cruise_control;
+        float fuel_amount;
+        bool engine_enabled;
+
+        float last_vertical_acceleration;
+        float terrain_impact_timer;
+        float terrain_smoothed_roughness;
+    };
+
+    /// frames published at frame end, read by the force loop without blocking the game thread
+    using telemetry_snapshot = seqlock_snapshot<telemetry_state_t>;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#define G923MAC_TIMING_WINDOW 512
+
+namespace g923mac {
+    struct rolling_summary {
+        std::size_t count;
+        std::uint64_t p50;
+        std::uint64_t p90;
+        std::uint64_t p99;
+        std::uint64_t max;
+    };
+
+    /// the last Window values of a series, percentiles are taken over that window only
+    template<std::size_t Window = G923MAC_TIMING_WINDOW>
+    class rolling_window {
+    public:
+        constexpr void push(std::uint64_t value) noexcept {
+            values_[next_] = value;
+            next_ = (next_ + 1) % Window;
+            if (count_ < Window) ++count_;
+        }
+
+        constexpr std::size_t size() const noexcept { return count_; }
+
+        constexpr void clear() noexcept { count_ = 0; next_ = 0; }
+
+        /// sorts a copy of the window, meant for reporting rather than the per-frame path
+        constexpr rolling_summary summary() const noexcept {
+            if (count_ == 0) return rolling_summary{0, 0, 0, 0, 0};
+
+            std::array<std::uint64_t, Window> sorted{};
+            std::copy(values_.begin(), values_.begin() + count_, sorted.begin());
+            std::sort(sorted.begin(), sorted.begin() + count_);
+
+            auto const at = [ & ](std::size_t per_mille) {
+                return sorted[(count_ - 1) * per_mille / 1000];
+            };
+
+            return rolling_summary{count_, at(500), at(900), at(990), sorted[count_ - 1]};
+        }
+
+    private:
+        std::array<std::uint64_t, Window> values_{};
+        std::size_t next_{0};
+        std::size_t count_{0};
+    };
+
+    /// game frame pacing from the frame_start timestamps (microseconds) and the cost of our frame_end work
+    class frame_timing {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        /// a restarted game timer or a rewind drops the deltas of that frame
+        constexpr void frame_start(std::uint64_t render_time_us, std::uint64_t simulation_time_us,
+                                   bool timer_restart) noexcept {
+            if (has_previous_ && !timer_restart && render_time_us >= last_render_us_ &&
+                simulation_time_us >= last_simulation_us_) {
+                std::uint64_t const render_delta = render_time_us - last_render_us_;
+
+                render_delta_.push(render_delta);
+                simulation_delta_.push(simulation_time_us - last_simulation_us_);
+
+                if (has_previous_delta_) {
+                    render_jitter_.push(render_delta > last_render_delta_ ? render_delta - last_render_delta_
+                                                                           : last_render_delta_ - render_delta);
+                }
+                last_render_delta_ = render_delta;
+                has_previous_delta_ = true;
+            } else {
+                has_previous_delta_ = false;
+            }
+
+            last_render_us_ = render_time_us;
+            last_simulation_us_ = simulation_time_us;
+            has_previous_ = true;
+        }
+
+        constexpr void frame_end(std::chrono::nanoseconds spent) noexcept {
+            frame_end_.push(static_cast<std::uint64_t>(spent.count() > 0 ? spent.count() : 0));
+        }
+
+        /// microseconds between rendered frames
+        constexpr rolling_summary render_delta() const noexcept { return render_delta_.summary(); }
+
+        /// microseconds of simulation advanced per frame
+        constexpr rolling_summary simulation_delta() const noexcept { return simulation_delta_.summary(); }
+
+        /// microseconds a render delta differs from the one before it
+        constexpr rolling_summary render_jitter() const noexcept { return render_jitter_.summary(); }
+
+        /// nanoseconds spent inside telemetry_frame_end
+        constexpr rolling_summary frame_end_time() const noexcept { return frame_end_.summary(); }
+
+        constexpr void reset() noexcept {
+            render_delta_.clear();
+            simulation_delta_.clear();
+            render_jitter_.clear();
+            frame_end_.clear();
+            has_previous_ = false;
+            has_previous_delta_ = false;
+        }
+
+    private:
+        rolling_window<> render_delta_;
+        rolling_window<> simulation_delta_;
+        rolling_window<> render_jitter_;
+        rolling_window<> frame_end_;
+
+        std::uint64_t last_render_us_{0};
+        std::uint64_t last_simulation_us_{0};
+        std::uint64_t last_render_delta_{0};
+        bool has_previous_{false};
+        bool has_previous_delta_{false};
+    };
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <concepts>
+#include <cstdint>
+#include <cstddef>
+#include <span>
+
+#if !defined(G923MAC_TRANSPORT_IOKIT) && !defined(G923MAC_TRANSPORT_HIDRAW) && !defined(G923MAC_TRANSPORT_MEMORY)
+#if defined(__APPLE__)
+#define G923MAC_TRANSPORT_IOKIT
+#elif defined(__linux__)
+#define G923MAC_TRANSPORT_HIDRAW
+#else
+#define G923MAC_TRANSPORT_MEMORY
+#endif
+#endif
+
+#if defined(G923MAC_TRANSPORT_IOKIT)
+#include <transport/iokit.hpp>
+#elif defined(G923MAC_TRANSPORT_HIDRAW)
+#include <transport/hidraw.hpp>
+#else
+#include <transport/memory.hpp>
+#endif
+
+namespace g923mac {
+    /// what every device backend provides, all calls take the backend's native device handle
+    /// enumerators are built from the device ids to match and report a generation that changes on hot-plug;
+    /// arrival() tells apart two arrivals of a device that may come back under the same handle
+    template<typename T>
+    concept hid_transport = requires(typename T::native_device *device, std::uint8_t const *data, std::size_t length,
+                                     typename T::result res, typename T::enumerator const &enumerator) {
+        { T::success } -> std::convertible_to<typename T::result>;
+        { T::error } -> std::convertible_to<typename T::result>;
+        { T::not_open } -> std::convertible_to<typename T::result>;
+        { T::no_device } -> std::convertible_to<typename T::result>;
+        { T::error_string(res) } -> std::convertible_to<char const *>;
+        { T::open(device) } -> std::same_as<typename T::result>;
+        { T::close(device) } -> std::same_as<typename T::result>;
+        { T::write(device, data, length) } -> std::same_as<typename T::result>;
+        { T::arrival(device) } -> std::same_as<std::uint64_t>;
+        typename T::enumerator;
+        requires std::constructible_from<typename T::enumerator, std::span<std::uint32_t const>>;
+        { enumerator.generation() } -> std::same_as<std::uint64_t>;
+    };
+
+#if defined(G923MAC_TRANSPORT_IOKIT)
+    using transport = iokit_transport;
+#elif defined(G923MAC_TRANSPORT_HIDRAW)
+    using transport = hidraw_transport;
+#else
+    using transport = memory_transport;
+#endif
+
+    static_assert(hid_transport<transport>);
+
+    using io_result_t = transport::result;
+
+    constexpr io_result_t io_success = transport::success;
+    constexpr io_result_t io_error = transport::error;
+    constexpr io_result_t io_not_open = transport::not_open;
+    constexpr io_result_t io_no_device = transport::no_device;
+}
@@ -0,0 +1,251 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <mutex>
+#include <span>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <linux/hidraw.h>
+
+#define G923MAC_HIDRAW_MAX_DEVICES 16
+
+namespace g923mac {
+    /// one arrival of a hidraw node, a device replugged at the same path is a new node with its own descriptor
+    struct hidraw_device {
+        char path[32];
+        dev_t rdev; // identify the node file of this arrival
+        ino_t inode;
+        std::uint64_t arrival; // unique per arrival, zero for a free slot
+
+        std::atomic<int> fd; // shared by every session on the node
+        unsigned opens; // sessions holding fd, guarded by the transport lock
+    };
+
+    /// linux /dev/hidraw backend, results are zero or a negated errno
+    struct hidraw_transport {
+        using native_device = hidraw_device;
+        using result = int;
+
+        static constexpr result success = 0;
+        static constexpr result error = -EIO;
+        static constexpr result not_open = -EBADF;
+        static constexpr result no_device = -ENODEV;
+
+        static char const *error_string(result res) noexcept { return strerror(-res); }
+
+        /// the first session opens the node, later ones share its descriptor
+        /// fails with no_device once the path belongs to a later arrival
+        static result open(native_device *device) noexcept {
+            std::lock_guard lock{_lock()};
+
+            if (device->opens > 0) {
+                ++device->opens;
+                return success;
+            }
+
+            int const fd = ::open(device->path, O_RDWR | O_CLOEXEC);
+            if (fd < 0) return _from_errno();
+
+            struct stat info{};
+            if (fstat(fd, &info) < 0 || !_same_node(*device, info)) {
+                ::close(fd);
+                return no_device;
+            }
+
+            device->fd.store(fd, std::memory_order_release);
+            device->opens = 1;
+            return success;
+        }
+
+        /// the last session closes the descriptor
+        static result close(native_device *device) noexcept {
+            std::lock_guard lock{_lock()};
+
+            if (device->opens == 0) return not_open;
+            if (--device->opens > 0) return success;
+
+            int const fd = device->fd.exchange(-1, std::memory_order_acq_rel);
+
+            return ::close(fd) < 0 ? _from_errno() : success;
+        }
+
+        static std::uint64_t arrival(native_device const *device) noexcept { return device->arrival; }
+
+        /// the device uses unnumbered reports, so every write is prefixed with report id 0
+        static result write(native_device *device, std::uint8_t const *data, std::size_t length) noexcept {
+            int const fd = device->fd.load(std::memory_order_acquire);
+            if (fd < 0) return not_open;
+
+            std::uint8_t buffer[1 + 64]{};
+
+            if (length > sizeof(buffer) - 1) return -EINVAL;
+
+            std::memcpy(buffer + 1, data, length);
+
+            return ::write(fd, buffer, length + 1) < 0 ? _from_errno() : success;
+        }
+
+        /// only nodes matching one of the ids (product id << 16 | vendor id) are enumerated, the ids are read
+        /// from sysfs so unrelated devices are never opened; nodes without sysfs are queried through the node
+        class enumerator {
+        public:
+            explicit enumerator(std::span<std::uint32_t const> device_ids) noexcept : device_ids_(device_ids) {
+            }
+
+            /// changes whenever a hidraw node is created or removed, /dev is touched on either
+            std::uint64_t generation() const noexcept {
+                struct stat dev{};
+                if (stat("/dev", &dev) < 0) return 0;
+
+                return static_cast<std::uint64_t>(dev.st_mtim.tv_sec) * 1'000'000'000u +
+                       static_cast<std::uint64_t>(dev.st_mtim.tv_nsec);
+            }
+
+            /// calls `callback(vendor_id, product_id, native_device *)` for every matching hidraw node
+            template<typename Callback>
+            void for_each(Callback &&callback) {
+                DIR *dir = opendir("/dev");
+                if (dir == nullptr) return;
+
+                while (dirent const *entry = readdir(dir)) {
+                    if (std::strncmp(entry->d_name, "hidraw", 6) != 0) continue;
+
+                    std::uint32_t vendor_id{0};
+                    std::uint32_t product_id{0};
+
+                    if (!_sysfs_ids(entry->d_name, vendor_id, product_id) &&
+                        !_node_ids(entry->d_name, vendor_id, product_id)) {
+                        continue;
+                    }
+                    if (!_matches(vendor_id, product_id)) continue;
+
+                    native_device *device = _node(entry->d_name);
+                    if (device == nullptr) continue;
+
+                    callback(vendor_id, product_id, device);
+                }
+
+                closedir(dir);
+            }
+
+        private:
+            std::span<std::uint32_t const> device_ids_;
+
+            bool _matches(std::uint32_t vendor_id, std::uint32_t product_id) const noexcept {
+                for (std::uint32_t const device_id: device_ids_) {
+                    if ((device_id & 0xFFFF) == vendor_id && (device_id >> 16) == product_id) return true;
+                }
+                return false;
+            }
+
+            /// parses `HID_ID=<bus>:<vendor>:<product>` from the node's uevent
+            static bool _sysfs_ids(char const *name, std::uint32_t &vendor_id, std::uint32_t &product_id) noexcept {
+                char path[64];
+                if (snprintf(path, sizeof(path), "/sys/class/hidraw/%s/device/uevent", name) >=
+                    static_cast<int>(sizeof(path))) {
+                    return false;
+                }
+
+                FILE *uevent = fopen(path, "re");
+                if (uevent == nullptr) return false;
+
+                char line[128];
+                bool found{false};
+
+                while (!found && fgets(line, sizeof(line), uevent) != nullptr) {
+                    unsigned bus, vendor, product;
+
+                    if (sscanf(line, "HID_ID=%x:%x:%x", &bus, &vendor, &product) == 3) {
+                        vendor_id = vendor & 0xFFFF;
+                        product_id = product & 0xFFFF;
+                        found = true;
+                    }
+                }
+
+                fclose(uevent);
+                return found;
+            }
+
+            static bool _node_ids(char const *name, std::uint32_t &vendor_id, std::uint32_t &product_id) noexcept {
+                char path[sizeof(native_device::path)];
+                if (snprintf(path, sizeof(path), "/dev/%s", name) >= static_cast<int>(sizeof(path))) return false;
+
+                int const fd = ::open(path, O_RDONLY | O_CLOEXEC);
+                if (fd < 0) return false;
+
+                hidraw_devinfo info{};
+                int const queried = ioctl(fd, HIDIOCGRAWINFO, &info);
+                ::close(fd);
+
+                if (queried < 0) return false;
+
+                vendor_id = static_cast<std::uint32_t>(static_cast<std::uint16_t>(info.vendor));
+                product_id = static_cast<std::uint32_t>(static_cast<std::uint16_t>(info.product));
+                return true;
+            }
+
+            /// nodes outlive enumerators so handles stay valid, like the device refs of a hid manager; a slot is
+            /// reused once its node is gone from /dev and no session holds it open
+            static native_device *_node(char const *name) noexcept {
+                static std::array<native_device, G923MAC_HIDRAW_MAX_DEVICES> nodes{};
+                static std::uint64_t arrivals{0};
+
+                char path[sizeof(native_device::path)];
+                if (snprintf(path, sizeof(path), "/dev/%s", name) >= static_cast<int>(sizeof(path))) return nullptr;
+
+                struct stat info{};
+                if (stat(path, &info) < 0) return nullptr;
+
+                std::lock_guard lock{_lock()};
+
+                native_device *free_node = nullptr;
+
+                for (auto &node: nodes) {
+                    if (node.arrival != 0 && std::strcmp(node.path, path) == 0 && _same_node(node, info)) return &node;
+                    if (free_node == nullptr && (node.arrival == 0 || (node.opens == 0 && !_present(node)))) {
+                        free_node = &node;
+                    }
+                }
+                if (free_node == nullptr) return nullptr;
+
+                std::memcpy(free_node->path, path, sizeof(path));
+                free_node->rdev = info.st_rdev;
+                free_node->inode = info.st_ino;
+                free_node->arrival = ++arrivals;
+                free_node->fd.store(-1, std::memory_order_relaxed);
+                free_node->opens = 0;
+
+                return free_node;
+            }
+
+            static bool _present(native_device const &node) noexcept {
+                struct stat info{};
+                return stat(node.path, &info) == 0 && _same_node(node, info);
+            }
+        };
+
+    private:
+        /// guards opening, closing and handing out nodes
+        static std::mutex &_lock() noexcept {
+            static std::mutex lock;
+            return lock;
+        }
+
+        static bool _same_node(native_device const &node, struct stat const &info) noexcept {
+            return node.rdev == info.st_rdev && node.inode == info.st_ino;
+        }
+
+        static result _from_errno() noexcept {
+            return (errno == ENOENT || errno == ENXIO) ? no_device : -errno;
+        }
+    };
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <ctime>
+#include <span>
+#include <IOKit/IOKitLib.h>
+#include <IOKit/IOReturn.h>
+#include <IOKit/hid/IOHIDDevice.h>
+#include <IOKit/hid/IOHIDManager.h>
+#include <mach/mach_error.h>
+
+namespace g923mac {
+    constexpr void set_applier_function_copy_to_cfarray(void const *value, void *context);
+    constexpr CFStringRef get_property_string(IOHIDDeviceRef hid_device, CFStringRef property);
+    constexpr std::uint32_t get_property_number(IOHIDDeviceRef hid_device, CFStringRef property);
+
+    /// macOS HID manager backend, devices are seized for exclusive access while open
+    struct iokit_transport {
+        using native_device = __IOHIDDevice;
+        using result = IOReturn;
+
+        static constexpr result success = kIOReturnSuccess;
+        static constexpr result error = kIOReturnError;
+        static constexpr result not_open = kIOReturnNotOpen;
+        static constexpr result no_device = kIOReturnNoDevice;
+
+        static constexpr char const *error_string(result res) noexcept { return mach_error_string(res); }
+
+        /// an open device is retained, so the handle outlives its removal from the manager
+        static result open(native_device *device) noexcept {
+            result const res = IOHIDDeviceOpen(device, kIOHIDOptionsTypeSeizeDevice);
+            if (res == kIOReturnSuccess) CFRetain(device);
+
+            return res;
+        }
+
+        static result close(native_device *device) noexcept {
+            result const res = IOHIDDeviceClose(device, 0);
+            CFRelease(device);
+
+            return res;
+        }
+
+        /// the registry entry id, a device that comes back is a new registry entry
+        static std::uint64_t arrival(native_device *device) noexcept {
+            std::uint64_t id{0};
+            IORegistryEntryGetRegistryEntryID(IOHIDDeviceGetService(device), &id);
+
+            return id;
+        }
+
+        static constexpr result write(native_device *device, std::uint8_t const *data, std::size_t length) noexcept {
+            return IOHIDDeviceSetReport(device, kIOHIDReportTypeOutput, time(nullptr), data, length);
+        }
+
+        /// only devices matching one of the ids (product id << 16 | vendor id) are enumerated,
+        /// the manager is opened without seizing, devices are seized one by one when opened
+        class enumerator {
+        public:
+            explicit enumerator(std::span<std::uint32_t const> device_ids) noexcept
+                : hid_manager_(_create_hid_manager(device_ids, &generation_, run_loop_)) {
+            }
+
+            enumerator(enumerator const &) = delete;
+            enumerator &operator=(enumerator const &) = delete;
+
+            ~enumerator() { _destroy_hid_manager(hid_manager_, run_loop_); }
+
+            /// changes whenever a matching device arrives or is removed
+            std::uint64_t generation() const noexcept { return generation_.load(std::memory_order_acquire); }
+
+            /// calls `callback(vendor_id, product_id, native_device *)` for every attached matching device
+            template<typename Callback>
+            constexpr void for_each(Callback &&callback) {
+                CFSetRef device_setref = IOHIDManagerCopyDevices(hid_manager_);
+                if (device_setref == nullptr) return;
+
+                CFIndex count = CFSetGetCount(device_setref);
+
+                CFMutableArrayRef device_arrayref = CFArrayCreateMutable(kCFAllocatorDefault, 0,
+                                                                         &kCFTypeArrayCallBacks);
+
+                CFSetApplyFunction(device_setref, set_applier_function_copy_to_cfarray,
+                                   static_cast<void *>(device_arrayref));
+
+                for (CFIndex i = 0; i < count; ++i) {
+                    native_device *device = (native_device *) CFArrayGetValueAtIndex(device_arrayref, i);
+
+                    std::uint32_t vendor_id = get_property_number(device, CFSTR(kIOHIDVendorIDKey));
+                    std::uint32_t product_id = get_property_number(device, CFSTR(kIOHIDProductIDKey));
+
+                    callback(vendor_id, product_id, device);
+                }
+
+                // the manager keeps its own reference on every device it matched
+                CFRelease(device_arrayref);
+                CFRelease(device_setref);
+            }
+
+        private:
+            std::atomic<std::uint64_t> generation_{0};
+            CFRunLoopRef run_loop_{CFRunLoopGetCurrent()}; // the creating thread's, the game's main thread
+            __IOHIDManager *hid_manager_;
+
+            static void _on_change(void *context, IOReturn, void *, IOHIDDeviceRef) noexcept {
+                static_cast<std::atomic<std::uint64_t> *>(context)->fetch_add(1, std::memory_order_release);
+            }
+
+            static __IOHIDManager *_create_hid_manager(std::span<std::uint32_t const> device_ids,
+                                                       std::atomic<std::uint64_t> *generation,
+                                                       CFRunLoopRef run_loop) {
+                __IOHIDManager *manager = IOHIDManagerCreate(kCFAllocatorDefault, kIOHIDManagerOptionNone);
+                CFMutableArrayRef matching = CFArrayCreateMutable(kCFAllocatorDefault, 0, &kCFTypeArrayCallBacks);
+
+                for (std::uint32_t const device_id: device_ids) {
+                    std::int32_t const vendor_id = static_cast<std::int32_t>(device_id & 0xFFFF);
+                    std::int32_t const product_id = static_cast<std::int32_t>(device_id >> 16);
+
+                    CFMutableDictionaryRef criteria = CFDictionaryCreateMutable(
+                        kCFAllocatorDefault, 0, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
+                    CFNumberRef vendor = CFNumberCreate(kCFAllocatorDefault, kCFNumberSInt32Type, &vendor_id);
+                    CFNumberRef product = CFNumberCreate(kCFAllocatorDefault, kCFNumberSInt32Type, &product_id);
+
+                    CFDictionarySetValue(criteria, CFSTR(kIOHIDVendorIDKey), vendor);
+                    CFDictionarySetValue(criteria, CFSTR(kIOHIDProductIDKey), product);
+                    CFArrayAppendValue(matching, criteria);
+
+                    CFRelease(product);
+                    CFRelease(vendor);
+                    CFRelease(criteria);
+                }
+
+                IOHIDManagerSetDeviceMatchingMultiple(manager, matching);
+                CFRelease(matching);
+
+                IOHIDManagerRegisterDeviceMatchingCallback(manager, _on_change, generation);
+                IOHIDManagerRegisterDeviceRemovalCallback(manager, _on_change, generation);
+                IOHIDManagerScheduleWithRunLoop(manager, run_loop, kCFRunLoopDefaultMode);
+
+                IOHIDManagerOpen(manager, kIOHIDOptionsTypeNone);
+
+                return manager;
+            }
+
+            static void _destroy_hid_manager(__IOHIDManager *manager, CFRunLoopRef run_loop) {
+                IOHIDManagerUnscheduleFromRunLoop(manager, run_loop, kCFRunLoopDefaultMode);
+                IOHIDManagerClose(manager, kIOHIDManagerOptionNone);
+                CFRelease(manager);
+            }
+        };
+    };
+
+    constexpr void set_applier_function_copy_to_cfarray(void const *value, void *context) {
+        CFArrayAppendValue(static_cast<CFMutableArrayRef>(context), value);
+    }
+
+    constexpr CFStringRef get_property_string(IOHIDDeviceRef hid_device, CFStringRef property) {
+        CFTypeRef data_ref = IOHIDDeviceGetProperty(hid_device, property);
+        return CFStringCreateCopy(kCFAllocatorDefault, CFStringRef(data_ref));
+    }
+
+    constexpr std::uint32_t get_property_number(IOHIDDeviceRef hid_device, CFStringRef property) {
+        CFTypeRef data_ref = IOHIDDeviceGetProperty(hid_device, property);
+
+        if (data_ref && (CFNumberGetTypeID() == CFGetTypeID(data_ref))) {
+            std::uint32_t number;
+            CFNumberGetValue((CFNumberRef) data_ref, kCFNumberSInt32Type, &number);
+            return number;
+        }
+
+        return 0;
+    }
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <thread>
+
+#define G923MAC_MEMORY_DEVICE_COUNT 1
+#define G923MAC_MEMORY_LOG_CAPACITY 4096
+
+namespace g923mac {
+    /// a sink that records every report written to it, with the time it was written
+    struct memory_device {
+        struct record {
+            std::uint64_t timestamp_ns;
+            std::uint8_t data[8];
+        };
+
+        std::uint32_t vendor_id;
+        std::uint32_t product_id;
+
+        std::atomic<bool> attached;
+        std::atomic<std::uint64_t> arrival; // bumped every time the device is plugged in
+        bool open;
+        std::chrono::nanoseconds write_latency;
+
+        std::atomic<std::uint64_t> writes;
+        std::atomic<std::uint64_t> bytes;
+        std::array<record, G923MAC_MEMORY_LOG_CAPACITY> log;
+
+        /// records are read only once writers have stopped; the log keeps the latest reports
+        std::size_t recorded() const noexcept {
+            std::uint64_t const count = writes.load(std::memory_order_acquire);
+            return count < log.size() ? count : log.size();
+        }
+
+        record const &at(std::size_t index) const noexcept {
+            std::uint64_t const count = writes.load(std::memory_order_acquire);
+            std::uint64_t const first = count < log.size() ? 0 : count - log.size();
+
+            return log[(first + index) % log.size()];
+        }
+
+        void reset() noexcept {
+            writes.store(0, std::memory_order_relaxed);
+            bytes.store(0, std::memory_order_relaxed);
+        }
+    };
+
+    /// in-process backend for running and measuring the force pipeline without a wheel attached
+    /// enumerates G923MAC_MEMORY_DEVICE_COUNT fake G923s, each write can be delayed to mimic the usb transfer
+    struct memory_transport {
+        using native_device = memory_device;
+        using result = int;
+
+        static constexpr result success = 0;
+        static constexpr result error = -1;
+        static constexpr result not_open = -2;
+        static constexpr result no_device = -3;
+
+        static constexpr char const *error_string(result res) noexcept {
+            switch (res) {
+                case success: return "success";
+                case not_open: return "device not open";
+                case no_device: return "no such device";
+                default: return "error";
+            }
+        }
+
+        static std::array<native_device, G923MAC_MEMORY_DEVICE_COUNT> &devices() noexcept {
+            static std::array<native_device, G923MAC_MEMORY_DEVICE_COUNT> devices{};
+            static bool const initialized = [] {
+                for (auto &device: devices) {
+                    device.vendor_id = 0x046d;
+                    device.product_id = 0xc266;
+                    device.attached.store(true, std::memory_order_relaxed);
+                }
+                return true;
+            }();
+            (void) initialized;
+
+            return devices;
+        }
+
+        /// bumped on every plug(), the enumerators report it as their generation
+        static std::atomic<std::uint64_t> &generation() noexcept {
+            static std::atomic<std::uint64_t> generation{0};
+            return generation;
+        }
+
+        /// simulates plugging the device in or pulling it out, writes to a pulled device fail with no_device
+        static void plug(native_device &device, bool attached) noexcept {
+            if (attached) device.arrival.fetch_add(1, std::memory_order_relaxed);
+            device.attached.store(attached, std::memory_order_release);
+            generation().fetch_add(1, std::memory_order_release);
+        }
+
+        static std::uint64_t arrival(native_device const *device) noexcept {
+            return device->arrival.load(std::memory_order_acquire);
+        }
+
+        static result open(native_device *device) noexcept {
+            if (!device->attached.load(std::memory_order_acquire)) return no_device;
+
+            device->open = true;
+            return success;
+        }
+
+        static constexpr result close(native_device *device) noexcept {
+            if (!device->open) return not_open;
+
+            device->open = false;
+            return success;
+        }
+
+        static result write(native_device *device, std::uint8_t const *data, std::size_t length) noexcept {
+            if (!device->attached.load(std::memory_order_acquire)) return no_device;
+            if (!device->open) return not_open;
+
+            if (device->write_latency.count() > 0) std::this_thread::sleep_for(device->write_latency);
+
+            std::uint64_t const index = device->writes.load(std::memory_order_relaxed);
+            auto &entry = device->log[index % device->log.size()];
+
+            entry.timestamp_ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+            std::memcpy(entry.data, data, length < sizeof(entry.data) ? length : sizeof(entry.data));
+
+            device->bytes.fetch_add(length, std::memory_order_relaxed);
+            device->writes.store(index + 1, std::memory_order_release);
+
+            return success;
+        }
+
+        /// only fake devices matching one of the ids (product id << 16 | vendor id) are enumerated
+        class enumerator {
+        public:
+            explicit constexpr enumerator(std::span<std::uint32_t const> device_ids) noexcept
+                : device_ids_(device_ids) {
+            }
+
+            /// changes on every plug()
+            std::uint64_t generation() const noexcept {
+                return memory_transport::generation().load(std::memory_order_acquire);
+            }
+
+            /// calls `callback(vendor_id, product_id, native_device *)` for every attached matching fake device
+            template<typename Callback>
+            void for_each(Callback &&callback) {
+                for (auto &device: devices()) {
+                    if (!device.attached.load(std::memory_order_acquire)) continue;
+
+                    for (std::uint32_t const device_id: device_ids_) {
+                        if ((device_id & 0xFFFF) == device.vendor_id && (device_id >> 16) == device.product_id) {
+                            callback(device.vendor_id, device.product_id, &device);
+                            break;
+                        }
+                    }
+                }
+            }
+
+        private:
+            std::span<std::uint32_t const> device_ids_;
+        };
+    };
+}
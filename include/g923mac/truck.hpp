@@ -0,0 +1,261 @@
+#pragma once
+
+#include <profile.hpp>
+#include <force_feedback_config.hpp>
+#include <scssdk_telemetry.h>
+#include <common/scssdk_telemetry_common_configs.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace g923mac {
+    /// the driven truck, from the truck configuration event; empty when there is no truck
+    struct truck_config {
+        std::string brand_id;
+        std::string brand;
+        std::string id; // model id, e.g. vehicle.kenworth.w900
+        std::string name;
+        std::uint32_t wheel_count;
+        std::uint32_t steerable_wheels;
+
+        bool operator==(truck_config const &) const = default;
+    };
+
+    /// `attributes` ends with an entry without a name
+    inline truck_config parse_truck_config(scs_named_value_t const *attributes) {
+        truck_config truck{{}, {}, {}, {}, 0, 0};
+
+        for (scs_named_value_t const *attribute = attributes; attribute->name != nullptr; ++attribute) {
+            std::string_view const name{attribute->name};
+            scs_value_t const &value = attribute->value;
+
+            if (value.type == SCS_VALUE_TYPE_string) {
+                if (name == SCS_TELEMETRY_CONFIG_ATTRIBUTE_brand_id) truck.brand_id = value.value_string.value;
+                else if (name == SCS_TELEMETRY_CONFIG_ATTRIBUTE_brand) truck.brand = value.value_string.value;
+                else if (name == SCS_TELEMETRY_CONFIG_ATTRIBUTE_id) truck.id = value.value_string.value;
+                else if (name == SCS_TELEMETRY_CONFIG_ATTRIBUTE_name) truck.name = value.value_string.value;
+            } else if (value.type == SCS_VALUE_TYPE_u32 && name == SCS_TELEMETRY_CONFIG_ATTRIBUTE_wheel_count) {
+                truck.wheel_count = value.value_u32.value;
+            } else if (value.type == SCS_VALUE_TYPE_bool && name == SCS_TELEMETRY_CONFIG_ATTRIBUTE_wheel_steerable) {
+                truck.steerable_wheels += value.value_bool.value != 0 ? 1 : 0;
+            }
+        }
+        return truck;
+    }
+
+    /// how a truck scales the feel of the profile in use, 1 leaves a knob as it is
+    struct truck_tuning {
+        float centering; // the center_* forces
+        float damping; // the damper_* coefficients and caps
+        float self_align; // sat_base_torque_factor
+
+        constexpr bool operator==(truck_tuning const &) const noexcept = default;
+
+        constexpr truck_tuning operator*(truck_tuning const &other) const noexcept {
+            return truck_tuning{centering * other.centering, damping * other.damping, self_align * other.self_align};
+        }
+    };
+
+    constexpr truck_tuning neutral_tuning{1.0f, 1.0f, 1.0f};
+
+    constexpr force_profile tuned(force_profile profile, truck_tuning const &tuning) noexcept {
+        for (float force_profile::*knob: {&force_profile::center_stationary_force,
+                                          &force_profile::center_low_speed_base, &force_profile::center_low_speed_factor,
+                                          &force_profile::center_highway_base, &force_profile::center_highway_factor,
+                                          &force_profile::center_max_force}) {
+            profile.*knob *= tuning.centering;
+        }
+        for (float force_profile::*knob: {&force_profile::damper_stationary_pos, &force_profile::damper_stationary_neg,
+                                          &force_profile::damper_low_speed, &force_profile::damper_max,
+                                          &force_profile::damper_max_total}) {
+            profile.*knob *= tuning.damping;
+        }
+        profile.sat_base_torque_factor *= tuning.self_align;
+
+        return profile;
+    }
+
+    /// trucks by axle layout, the wheels of an axle count as two however many tires they carry
+    enum class truck_class : std::uint8_t {
+        none, // no truck configured
+        two_axle, // 4x2, what ffb_config is tuned for
+        three_axle, // 6x2 and 6x4
+        multi_axle, // four or more axles, or two steered axles
+        count
+    };
+
+    constexpr char const *truck_class_name(truck_class kind) noexcept {
+        switch (kind) {
+            case truck_class::none: return "none";
+            case truck_class::two_axle: return "two-axle";
+            case truck_class::three_axle: return "three-axle";
+            case truck_class::multi_axle: return "multi-axle";
+            default: return "unknown";
+        }
+    }
+
+    constexpr std::array<truck_tuning, static_cast<std::size_t>(truck_class::count)> truck_class_tunings{
+        neutral_tuning,
+        neutral_tuning,
+        truck_tuning{1.1f, 1.15f, 1.05f},
+        truck_tuning{1.25f, 1.35f, 1.1f},
+    };
+
+    constexpr truck_class classify_truck(std::uint32_t wheel_count, std::uint32_t steerable_wheels) noexcept {
+        std::uint32_t const axles = (wheel_count + 1) / 2;
+
+        if (axles == 0) return truck_class::none;
+        if (axles >= 4 || steerable_wheels >= 4) return truck_class::multi_axle;
+        if (axles == 3) return truck_class::three_axle;
+        return truck_class::two_axle;
+    }
+
+    constexpr std::uint64_t fnv1a(std::string_view text) noexcept {
+        std::uint64_t hash{0xcbf29ce484222325u};
+
+        for (char const c: text) {
+            hash ^= static_cast<std::uint8_t>(c);
+            hash *= 0x100000001b3u;
+        }
+        return hash;
+    }
+
+    /// string keys to values in an open-addressed table filled at compile time, a lookup hashes the key once and
+    /// probes linearly; the keys must outlive the table
+    template<typename Value, std::size_t Capacity>
+    class static_string_map {
+        static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+    public:
+        using entry = std::pair<std::string_view, Value>;
+
+        template<std::size_t Count>
+        constexpr explicit static_string_map(std::array<entry, Count> const &entries) noexcept {
+            static_assert(Count * 2 <= Capacity, "keep the table at most half full");
+
+            for (entry const &e: entries) {
+                std::size_t i = fnv1a(e.first) & (Capacity - 1);
+                while (slots_[i].used) i = (i + 1) & (Capacity - 1);
+
+                slots_[i] = slot{e.first, e.second, true};
+            }
+        }
+
+        constexpr Value const *find(std::string_view key) const noexcept {
+            for (std::size_t i = fnv1a(key) & (Capacity - 1); slots_[i].used; i = (i + 1) & (Capacity - 1)) {
+                if (slots_[i].key == key) return &slots_[i].value;
+            }
+            return nullptr;
+        }
+
+    private:
+        struct slot {
+            std::string_view key;
+            Value value;
+            bool used;
+        };
+
+        std::array<slot, Capacity> slots_{};
+    };
+
+    /// models whose steering differs from the rest of their class, on top of the class tuning
+    /// long-nosed conventionals carry the front axle further forward and steer heavier
+    constexpr std::array<static_string_map<truck_tuning, 16>::entry, 4> truck_model_entries{{
+        {"vehicle.kenworth.w900", truck_tuning{1.1f, 1.1f, 1.1f}},
+        {"vehicle.peterbilt.389", truck_tuning{1.1f, 1.1f, 1.1f}},
+        {"vehicle.westernstar.49x", truck_tuning{1.05f, 1.05f, 1.05f}},
+        {"vehicle.westernstar.5700xe", truck_tuning{1.05f, 1.05f, 1.05f}},
+    }};
+
+    constexpr static_string_map<truck_tuning, 16> truck_model_tunings{truck_model_entries};
+
+    namespace detail {
+        constexpr bool finds_every_model() noexcept {
+            for (auto const &[id, tuning]: truck_model_entries) {
+                truck_tuning const *const found = truck_model_tunings.find(id);
+                if (found == nullptr || !(*found == tuning)) return false;
+            }
+            return truck_model_tunings.find("vehicle.unknown") == nullptr;
+        }
+    }
+
+    static_assert(detail::finds_every_model());
+
+    struct truck_selection {
+        truck_class kind;
+        bool known_model; // found in truck_model_tunings
+        truck_tuning tuning;
+    };
+
+    constexpr truck_selection select_truck(std::string_view id, std::uint32_t wheel_count,
+                                           std::uint32_t steerable_wheels) noexcept {
+        truck_class const kind = classify_truck(wheel_count, steerable_wheels);
+        truck_tuning const tuning = truck_class_tunings[static_cast<std::size_t>(kind)];
+
+        if (kind == truck_class::none) return truck_selection{kind, false, tuning};
+
+        if (truck_tuning const *const model = truck_model_tunings.find(id)) {
+            return truck_selection{kind, true, tuning * *model};
+        }
+        return truck_selection{kind, false, tuning};
+    }
+
+    inline truck_selection select_truck(truck_config const &truck) noexcept {
+        return select_truck(truck.id, truck.wheel_count, truck.steerable_wheels);
+    }
+
+    /// writes to a profile_store the profile file with the tuning of the driven truck applied, again whenever
+    /// either changes; the profile watcher and the game thread both write through it
+    class tuned_profiles {
+    public:
+        explicit tuned_profiles(profile_store &store) noexcept : store_(store) {
+        }
+
+        tuned_profiles(tuned_profiles const &) = delete;
+        tuned_profiles &operator=(tuned_profiles const &) = delete;
+
+        void load(force_profile const &values) {
+            std::lock_guard lock{mutex_};
+
+            base_ = values;
+            custom_base_ = true;
+            _publish();
+        }
+
+        void reset() {
+            std::lock_guard lock{mutex_};
+
+            base_ = force_profile{};
+            custom_base_ = false;
+            _publish();
+        }
+
+        /// false when `tuning` already applies, nothing is rebuilt then
+        bool tune(truck_tuning const &tuning) {
+            std::lock_guard lock{mutex_};
+
+            if (tuning == tuning_) return false;
+
+            tuning_ = tuning;
+            _publish();
+            return true;
+        }
+
+    private:
+        profile_store &store_;
+        std::mutex mutex_;
+        force_profile base_{};
+        bool custom_base_{false};
+        truck_tuning tuning_{neutral_tuning};
+
+        void _publish() {
+            if (!custom_base_ && tuning_ == neutral_tuning) store_.reset();
+            else store_.load(tuned(base_, tuning_));
+        }
+    };
+}
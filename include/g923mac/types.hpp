@@ -2,13 +2,11 @@
 
 #include <array>
 #include <vector>
-#include <IOKit/hid/IOHIDDevice.h>
-#include <IOKit/hid/IOHIDManager.h>
+#include <transport.hpp>
 
 namespace g923mac {
     using device_id_t = std::uint32_t;
-    using hid_device_t = __IOHIDDevice;
-    using hid_manager_t = __IOHIDManager;
+    using hid_device_t = transport::native_device;
 
     template<typename T>
     using vector = std::vector<T>;
@@ -1,8 +1,7 @@
 #pragma once
 
 #include <cstdio>
-#include <IOKit/IOReturn.h>
-#include <mach/mach_error.h>
+#include <transport.hpp>
 
 #define G923MAC_VERSION "0.0.1"
 
@@ -23,13 +22,13 @@ namespace g923mac {
     constexpr char const *terminal_green_cstr() { return "\033[32m"; }
     constexpr char const *terminal_yellow_cstr() { return "\033[33m"; }
 
-    constexpr bool _try(char const *loc, IOReturn result) noexcept {
-        if (result != kIOReturnSuccess) {
+    constexpr bool _try(char const *loc, io_result_t result) noexcept {
+        if (result != io_success) {
             terminal_bold();
             terminal_red();
             printf("=== g923mac::error ");
             terminal_reset();
-            printf(": %s failed with error code %x (%s)\n", loc, result, mach_error_string(result));
+            printf(": %s failed with error code %x (%s)\n", loc, result, transport::error_string(result));
 
             return false;
         }
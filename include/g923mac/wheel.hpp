@@ -4,248 +4,328 @@
 #include <types.hpp>
 #include <command.hpp>
 #include <device.hpp>
+#include <session.hpp>
+#include <writer.hpp>
+#include <shadow.hpp>
+#include <effects.hpp>
+#include <protocol.hpp>
+#include <lifecycle.hpp>
+#include <calibration.hpp>
+#include <force_feedback_config.hpp>
+#include <chrono>
 #include <ctime>
-#include <mach/mach_error.h>
-
-#define G923_DEV_ID 0xc266046d
+#include <memory>
+#include <optional>
+#include <variant>
 
 namespace g923mac {
+    /// a wheel speaking `Protocol`, reports are encoded at compile time for that device
+    template<wheel_protocol Protocol>
     class wheel {
     public:
-        constexpr wheel() noexcept : device_{0, 0, 0, nullptr} {
+        using protocol = Protocol;
+
+        wheel() noexcept : wheel(hid_device{0, 0, 0, nullptr}) {
         }
 
-        constexpr wheel(hid_device const &device) noexcept : device_(device) {
+        wheel(hid_device const &device) noexcept
+            : writer_(std::make_unique<report_writer>(device_session(device))) {
         }
 
-        constexpr device_id_t vendor_id() const noexcept { return device_.vendor_id_; }
-        constexpr device_id_t product_id() const noexcept { return device_.product_id_; }
-        constexpr device_id_t device_id() const noexcept { return device_.device_id_; }
+        constexpr device_id_t vendor_id() const noexcept { return device().vendor_id_; }
+        constexpr device_id_t product_id() const noexcept { return device().product_id_; }
+        constexpr device_id_t device_id() const noexcept { return device().device_id_; }
 
-        constexpr hid_device_t *device_ref() noexcept { return device_.hid_device_; }
-        constexpr hid_device_t const *device_ref() const noexcept { return device_.hid_device_; }
+        constexpr hid_device_t const *device_ref() const noexcept { return device().hid_device_; }
 
-        constexpr hid_device &device() noexcept { return device_; }
-        constexpr hid_device const &device() const noexcept { return device_; }
+        constexpr hid_device const &device() const noexcept { return writer_->device(); }
 
-        constexpr operator bool() const noexcept { return device_.hid_device_ != nullptr; }
+        writer_stats stats() const noexcept { return writer_->stats(); }
 
-        constexpr bool calibrate() noexcept {
-            if (!set_led_pattern(0)) return false;
+        std::size_t backlog() const noexcept { return writer_->backlog(); }
 
-            for (int i = 0; i < 32; ++i) {
-                usleep(30 * 1000);
-                set_led_pattern(i);
-            }
-            for (int i = 31; i >= 0; --i) {
-                usleep(30 * 1000);
-                set_led_pattern(i);
-            }
-            disable_autocenter();
-            set_constant_force(120);
-            usleep(500 * 1000);
-            stop_forces();
-            set_autocenter_spring(2, 2, 48);
+        void set_write_interval(std::chrono::nanoseconds interval) noexcept { writer_->set_write_interval(interval); }
 
-            if (!enable_autocenter()) return false;
+        constexpr std::uint64_t suppressed_reports() const noexcept { return shadow_.suppressed(); }
 
-            usleep(500 * 1000);
+        constexpr effect_slots const &effects() const noexcept { return effects_; }
 
-            return true;
+        /// hands all further reports to the wheel's writer thread
+        void start_writer(overflow_policy policy) { writer_->start(policy); }
+
+        void stop_writer() { writer_->stop(); }
+
+        constexpr operator bool() const noexcept { return device().hid_device_ != nullptr; }
+
+        constexpr wheel_state state() const noexcept { return state_; }
+
+        /// runs the startup sweep, the wheel ends up active or faulted (also when cancelled)
+        bool calibrate(calibration_options const &options = {}) noexcept {
+            if (!_enter(wheel_state::calibrating)) return false;
+
+            bool const calibrated = _calibrate(options);
+
+            _enter(calibrated ? wheel_state::active : wheel_state::faulted);
+            return calibrated;
         }
 
-        constexpr bool disable_autocenter() noexcept {
-            report rep;
+        /// stops every effect and darkens the leds once, a paused wheel then sends nothing until resumed
+        bool pause() noexcept {
+            if (state_ == wheel_state::paused) return true;
 
-            switch (device_.device_id_) {
-                case G923_DEV_ID:
-                    rep.cmd[0] = 0xF5;
-                    break ;
-                default:
-                    /// unreachable
-                    break ;
+            bool stopped{true};
+            wheel_state const before = state_;
+
+            if (state_ == wheel_state::active || state_ == wheel_state::faulted) {
+                if (!stop_forces()) stopped = false;
+                if (!disable_autocenter()) stopped = false;
+                if (!set_led_pattern(0)) stopped = false;
             }
-            print_info("sending 'disable autocenter' command...");
 
-            return _send_report(rep);
+            if (_enter(wheel_state::paused)) resume_state_ = before;
+            return stopped;
         }
 
-        constexpr bool enable_autocenter() noexcept {
-            report rep;
+        /// back to the state the wheel was paused in, a disconnected wheel keeps waiting out its probe interval;
+        /// the next force update brings the stopped effects back
+        void resume() noexcept {
+            if (state_ == wheel_state::paused) _enter(resume_state_);
+        }
+
+        /// adds the effect downloads of this update to the batch, slots already playing are updated in place
+        template<std::size_t Capacity>
+        constexpr void stage_effects(effect_set const &wanted, report_batch<Capacity> &batch) const noexcept {
+            effects_.stage(wanted, make_stop_slots, batch);
+        }
+
+        /// writes every report of the batch the wheel does not already hold, in one submission
+        template<std::size_t Capacity>
+        bool send(report_batch<Capacity> const &batch) noexcept {
+            auto const now = report_shadow::clock::now();
+
+            _track_health();
+            if (!_may_send(now)) return true;
+
+            report_batch<Capacity> pending;
+
+            // commit as we go, a report may invalidate what the rest of the batch is compared against
+            for (auto const &rep: batch) {
+                effects_.commit(rep);
 
-            switch (device_.device_id_) {
-                case G923_DEV_ID:
-                    rep.cmd[0] = 0xF4;
-                    break ;
-                default:
-                    /// unreachable
-                    break ;
+                if (shadow_.should_send(rep, now)) {
+                    pending.push(rep);
+                    shadow_.commit(rep, now);
+                }
+            }
+            if (!writer_->submit(pending)) {
+                shadow_.invalidate();
+                return false;
             }
-            print_info("sending 'enable autocenter' command...");
 
-            return _send_report(rep);
+            print_info("send successful");
+            return true;
         }
 
-        constexpr bool set_autocenter_spring(std::uint8_t k1, std::uint8_t k2, std::uint8_t clip) noexcept {
-            report rep;
+        bool disable_autocenter() noexcept {
+            print_info("sending 'disable autocenter' command...");
 
-            switch (device_.device_id_) {
-                case G923_DEV_ID:
-                    rep.cmd[0] = 0xFE;
-                    rep.cmd[1] = 0x00;
-                    rep.cmd[2] = k1;
-                    rep.cmd[3] = k2;
-                    rep.cmd[4] = clip;
-                    rep.cmd[5] = 0x00;
-                    break ;
-                default:
-                    /// unreachable
-                    break ;
-            }
+            return _send_report(make_disable_autocenter());
+        }
+
+        bool enable_autocenter() noexcept {
+            print_info("sending 'enable autocenter' command...");
+
+            return _send_report(make_enable_autocenter());
+        }
+
+        bool set_autocenter_spring(std::uint8_t k1, std::uint8_t k2, std::uint8_t clip) noexcept {
             print_info("sending 'set autocenter spring' command...");
 
-            return _send_report(rep);
-        }
-
-        constexpr bool set_custom_spring(std::uint8_t d1, std::uint8_t d2, std::uint8_t k1, std::uint8_t k2,
-                                         std::uint8_t s1, std::uint8_t s2, std::uint8_t clip) {
-            report rep;
-
-            switch (device_.device_id_) {
-                case G923_DEV_ID:
-                    rep.cmd[0] = 0xF1;
-                    rep.cmd[1] = 0x01;
-                    rep.cmd[2] = d1;
-                    rep.cmd[3] = d2;
-                    rep.cmd[4] = (k2 << 4) | k1;
-                    rep.cmd[5] = (s2 << 4) | s1;
-                    rep.cmd[6] = clip;
-                    break ;
-                default:
-                    /// unreachable
-                    break ;
-            }
+            return _send_report(make_autocenter_spring(k1, k2, clip));
+        }
+
+        bool set_custom_spring(std::uint8_t d1, std::uint8_t d2, std::uint8_t k1, std::uint8_t k2,
+                               std::uint8_t s1, std::uint8_t s2, std::uint8_t clip) noexcept {
             print_info("sending 'set custom spring' command...");
 
-            return _send_report(rep);
-        }
-
-        constexpr bool set_constant_force(std::uint8_t force_level) {
-            report rep;
-
-            switch (device_.device_id_) {
-                case G923_DEV_ID:
-                    rep.cmd[0] = 0xF1;
-                    rep.cmd[1] = 0x00;
-                    rep.cmd[2] = force_level;
-                    rep.cmd[3] = force_level;
-                    rep.cmd[4] = force_level;
-                    rep.cmd[5] = force_level;
-                    rep.cmd[6] = 0x00;
-                    break ;
-                default:
-                    /// unreachable
-                    break ;
-            }
+            return _send_report(make_custom_spring(d1, d2, k1, k2, s1, s2, clip));
+        }
+
+        bool set_constant_force(std::uint8_t force_level) noexcept {
             print_info("sending 'set constant force' command...");
 
-            return _send_report(rep);
-        }
-
-        constexpr bool set_damper(std::uint8_t k1, std::uint8_t k2, std::uint8_t s1, std::uint8_t s2) {
-            report rep;
-
-            switch (device_.device_id_) {
-                case G923_DEV_ID:
-                    rep.cmd[0] = 0xF1;
-                    rep.cmd[1] = 0x02;
-                    rep.cmd[2] = k1;
-                    rep.cmd[3] = s1;
-                    rep.cmd[4] = k2;
-                    rep.cmd[5] = s2;
-                    rep.cmd[6] = 0x00;
-                    break ;
-                default:
-                    /// unreachable
-                    break ;
-            }
+            return _send_report(make_constant_force(force_level));
+        }
+
+        bool set_damper(std::uint8_t k1, std::uint8_t k2, std::uint8_t s1, std::uint8_t s2) noexcept {
             print_info("sending 'set damper' command...");
 
-            return _send_report(rep);
-        }
-
-        constexpr bool set_trapezoid(std::uint8_t l1, std::uint8_t l2, std::uint8_t t1, std::uint8_t t2,
-                                     std::uint8_t t3, std::uint8_t s) {
-            report rep;
-
-            switch (device_.device_id_) {
-                case G923_DEV_ID:
-                    rep.cmd[0] = 0xF1;
-                    rep.cmd[1] = 0x06;
-                    rep.cmd[2] = l1;
-                    rep.cmd[3] = l2;
-                    rep.cmd[4] = t1;
-                    rep.cmd[5] = t2;
-                    rep.cmd[6] = (t3 << 4) | s;
-                    break ;
-                default:
-                    /// unreachable
-                    break ;
-            }
+            return _send_report(make_damper(k1, k2, s1, s2));
+        }
+
+        bool set_trapezoid(std::uint8_t l1, std::uint8_t l2, std::uint8_t t1, std::uint8_t t2,
+                           std::uint8_t t3, std::uint8_t s) noexcept {
             print_info("sending 'set trapezoid' command...");
 
-            return _send_report(rep);
+            return _send_report(make_trapezoid(l1, l2, t1, t2, t3, s));
         }
 
-        constexpr bool stop_forces() {
-            report rep;
-
-            switch (device_.device_id_) {
-                case G923_DEV_ID:
-                    rep.cmd[0] = 0xF3;
-                    rep.cmd[1] = 0x00;
-                    break ;
-                default:
-                    /// unreachable
-                    break ;
-            }
+        bool stop_forces() noexcept {
             print_info("sending 'stop forces' command...");
 
-            return _send_report(rep);
+            return _send_report(make_stop_forces());
         }
 
-        constexpr bool set_led_pattern(std::uint8_t pattern) {
-            report rep;
-
-            switch (device_.device_id_) {
-                case G923_DEV_ID:
-                    rep.cmd[0] = 0xF8;
-                    rep.cmd[1] = 0x12;
-                    rep.cmd[2] = pattern;
-                    break ;
-                default:
-                    /// unreachable
-                    break ;
-            }
+        bool set_led_pattern(std::uint8_t pattern) noexcept {
             print_info("sending 'set led pattern' command...");
 
-            return _send_report(rep);
+            return _send_report(make_led_pattern(pattern));
+        }
+
+        static constexpr report make_disable_autocenter() noexcept { return protocol::disable_autocenter(); }
+
+        static constexpr report make_enable_autocenter() noexcept { return protocol::enable_autocenter(); }
+
+        static constexpr report make_autocenter_spring(std::uint8_t k1, std::uint8_t k2, std::uint8_t clip) noexcept {
+            return protocol::autocenter_spring(k1, k2, clip);
+        }
+
+        static constexpr report make_custom_spring(std::uint8_t d1, std::uint8_t d2, std::uint8_t k1, std::uint8_t k2,
+                                                   std::uint8_t s1, std::uint8_t s2, std::uint8_t clip) noexcept {
+            return protocol::custom_spring(d1, d2, k1, k2, s1, s2, clip);
+        }
+
+        static constexpr report make_constant_force(std::uint8_t force_level) noexcept {
+            return protocol::constant_force(force_level);
+        }
+
+        static constexpr report make_damper(std::uint8_t k1, std::uint8_t k2, std::uint8_t s1,
+                                            std::uint8_t s2) noexcept {
+            return protocol::damper(k1, k2, s1, s2);
+        }
+
+        static constexpr report make_trapezoid(std::uint8_t l1, std::uint8_t l2, std::uint8_t t1, std::uint8_t t2,
+                                               std::uint8_t t3, std::uint8_t s) noexcept {
+            return protocol::trapezoid(l1, l2, t1, t2, t3, s);
+        }
+
+        static constexpr report make_stop_slots(std::uint8_t slots) noexcept { return protocol::stop_slots(slots); }
+
+        static constexpr report make_stop_forces() noexcept { return protocol::stop_forces(); }
+
+        static constexpr report make_led_pattern(std::uint8_t pattern) noexcept {
+            return protocol::led_pattern(pattern);
         }
 
     private:
-        hid_device device_;
+        std::unique_ptr<report_writer> writer_;
+        report_shadow shadow_;
+        effect_slots effects_;
+        std::uint64_t seen_failures_{0};
+        std::uint64_t seen_written_{0};
+        wheel_state state_{wheel_state::uninitialized};
+        wheel_state resume_state_{wheel_state::active}; // what state_ was before the pause
+        report_shadow::clock::time_point next_probe_{};
+
+        bool _enter(wheel_state to) noexcept {
+            if (!can_transition(state_, to)) return false;
+
+            state_ = to;
+            return true;
+        }
+
+        bool _calibrate(calibration_options const &options) noexcept {
+            using std::chrono::milliseconds;
 
-        constexpr bool _send_report(report const &rep) noexcept {
-            if (!_try("_send_report::open_device", open_device(device_))) { return false; }
-            if (!_try("_send_report", send_report(device_, rep))) {
-                close_device(device_);
+            if (!set_led_pattern(0)) return false;
+
+            if (options.led_sweep) {
+                for (int i = 0; i < 32; ++i) {
+                    if (!calibration_wait(options, milliseconds(30))) return false;
+                    set_led_pattern(i);
+                }
+                for (int i = 31; i >= 0; --i) {
+                    if (!calibration_wait(options, milliseconds(30))) return false;
+                    set_led_pattern(i);
+                }
+            }
+            disable_autocenter();
+            set_constant_force(120);
+            if (!calibration_wait(options, milliseconds(500))) {
+                stop_forces();
                 return false;
             }
+            stop_forces();
+            set_autocenter_spring(2, 2, 48);
 
-            close_device(device_);
+            if (!enable_autocenter()) return false;
+
+            return calibration_wait(options, milliseconds(500));
+        }
+
+        // a failed write leaves the device state unknown, resend everything once it takes writes again
+        void _track_health() noexcept {
+            writer_stats const stats = writer_->stats();
+
+            if (stats.failed != seen_failures_) {
+                seen_failures_ = stats.failed;
+                shadow_.invalidate();
+
+                if (state_ == wheel_state::active || state_ == wheel_state::faulted ||
+                    state_ == wheel_state::disconnected) {
+                    _enter(writer_->last_error() == io_no_device ? wheel_state::disconnected : wheel_state::faulted);
+                }
+            } else if (stats.written != seen_written_ &&
+                       (state_ == wheel_state::faulted || state_ == wheel_state::disconnected)) {
+                _enter(wheel_state::active);
+            }
+
+            seen_written_ = stats.written;
+        }
+
+        /// a disconnected wheel gets one attempt per probe interval, each one reopens the device
+        bool _may_send(report_shadow::clock::time_point now) noexcept {
+            if (!sends_reports(state_)) return false;
+            if (state_ != wheel_state::disconnected) return true;
+            if (now < next_probe_) return false;
+
+            next_probe_ = now + std::chrono::milliseconds(ffb_config::disconnected_probe_interval_ms);
+            return true;
+        }
+
+        bool _send_report(report const &rep) noexcept {
+            auto const now = report_shadow::clock::now();
+
+            _track_health();
+            if (!_may_send(now)) return true;
+
+            effects_.commit(rep);
+
+            if (!shadow_.should_send(rep, now)) { return true; }
+            if (!writer_->submit(rep)) { return false; }
+
+            shadow_.commit(rep, now);
 
             print_info("_send_report successful");
             return true;
         }
     };
+
+    /// every supported wheel, the alternative is picked once from the device id when the wheel is created
+    using any_wheel = std::variant<wheel<g923_protocol>>;
+
+    /// an empty optional when no protocol drives the device
+    template<std::size_t Index = 0>
+    std::optional<any_wheel> make_wheel(hid_device const &device) noexcept {
+        if constexpr (Index == std::variant_size_v<any_wheel>) {
+            return std::nullopt;
+        } else {
+            using candidate = std::variant_alternative_t<Index, any_wheel>;
+
+            if (device.device_id_ == candidate::protocol::device_id) {
+                return std::optional<any_wheel>(std::in_place, std::in_place_index<Index>, device);
+            }
+            return make_wheel<Index + 1>(device);
+        }
+    }
 }
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <util.hpp>
+#include <types.hpp>
+#include <command.hpp>
+#include <session.hpp>
+#include <ring.hpp>
+#include <scheduler.hpp>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <utility>
+
+namespace g923mac {
+    struct writer_stats {
+        std::uint64_t enqueued;
+        std::uint64_t dropped;
+        std::uint64_t coalesced;
+        std::uint64_t written;
+        std::uint64_t failed;
+        std::uint32_t reopens;
+        std::uint64_t write_ns; // total time spent in device writes
+    };
+
+    /// drains a report ring into a device session on a dedicated thread
+    /// the thread writes through a scheduler, so pending reports go out by priority and paced to the report interval
+    /// until started, submitted reports are written synchronously on the caller's thread
+    class report_writer {
+    public:
+        explicit report_writer(device_session &&session) noexcept : session_(std::move(session)) {
+        }
+
+        report_writer(report_writer const &) = delete;
+        report_writer &operator=(report_writer const &) = delete;
+
+        ~report_writer() { stop(); }
+
+        constexpr hid_device const &device() const noexcept { return session_.device(); }
+
+        bool running() const noexcept { return running_.load(std::memory_order_acquire); }
+
+        void start(overflow_policy policy) {
+            if (running()) return;
+
+            policy_ = policy;
+            running_.store(true, std::memory_order_release);
+            thread_ = std::thread([ this ] { _run(); });
+        }
+
+        /// pending reports are flushed before the thread exits
+        void stop() {
+            if (!running()) return;
+
+            running_.store(false, std::memory_order_release);
+            _wake();
+            thread_.join();
+        }
+
+        /// producer side, never blocks on the device once the writer is running
+        bool submit(report const &rep) noexcept {
+            if (!running()) return _write(rep);
+
+            bool const accepted = _enqueue(rep);
+            _notify();
+
+            return accepted;
+        }
+
+        /// enqueues the whole batch before waking the writer once
+        template<std::size_t Capacity>
+        bool submit(report_batch<Capacity> const &batch) noexcept {
+            if (batch.empty()) return true;
+            if (!running()) return _write(batch);
+
+            bool accepted{true};
+
+            for (auto const &rep: batch) {
+                if (!_enqueue(rep)) accepted = false;
+            }
+            _notify();
+
+            return accepted;
+        }
+
+        std::uint64_t failures() const noexcept { return failed_.load(std::memory_order_relaxed); }
+
+        /// result of the most recent failed write
+        io_result_t last_error() const noexcept { return last_error_.load(std::memory_order_relaxed); }
+
+        /// reports queued or scheduled but not yet written
+        std::size_t backlog() const noexcept {
+            return ring_.size() + scheduled_.load(std::memory_order_relaxed);
+        }
+
+        /// spacing between writes, applied by the writer thread before its next write
+        void set_write_interval(std::chrono::nanoseconds interval) noexcept {
+            write_interval_ns_.store(interval.count(), std::memory_order_relaxed);
+        }
+
+        writer_stats stats() const noexcept {
+            return writer_stats{
+                enqueued_.load(std::memory_order_relaxed),
+                dropped_.load(std::memory_order_relaxed),
+                coalesced_.load(std::memory_order_relaxed),
+                written_.load(std::memory_order_relaxed),
+                failed_.load(std::memory_order_relaxed),
+                reopens_.load(std::memory_order_relaxed),
+                write_ns_.load(std::memory_order_relaxed),
+            };
+        }
+
+    private:
+        report_ring<> ring_;
+        report_scheduler scheduler_;
+        device_session session_;
+        overflow_policy policy_{overflow_policy::latest_wins};
+
+        std::thread thread_;
+        std::atomic<bool> running_{false};
+        std::atomic<bool> parked_{false};
+        std::atomic<std::uint32_t> signal_{0};
+
+        std::atomic<std::uint64_t> enqueued_{0};
+        std::atomic<std::uint64_t> dropped_{0};
+        std::atomic<std::uint64_t> coalesced_{0};
+        std::atomic<std::uint64_t> written_{0};
+        std::atomic<std::uint64_t> failed_{0};
+        std::atomic<std::uint32_t> reopens_{0};
+        std::atomic<std::uint64_t> write_ns_{0};
+        std::atomic<io_result_t> last_error_{io_success};
+
+        std::atomic<std::size_t> scheduled_{0};
+        std::atomic<std::int64_t> write_interval_ns_{
+            std::chrono::nanoseconds(std::chrono::microseconds(ffb_config::report_interval_us)).count()
+        };
+
+        bool _enqueue(report const &rep) noexcept {
+            std::uint32_t coalesced{0};
+            push_result const result = ring_.push(rep, policy_, coalesced);
+
+            if (coalesced) coalesced_.fetch_add(coalesced, std::memory_order_relaxed);
+            if (result == push_result::rejected || result == push_result::replaced_oldest) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (result == push_result::rejected) return false;
+
+            enqueued_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        void _notify() noexcept {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (parked_.load(std::memory_order_relaxed)) _wake();
+        }
+
+        bool _write(report const &rep) noexcept {
+            auto const start = std::chrono::steady_clock::now();
+            io_result_t const result = session_.send(rep);
+            bool const written = _try("report_writer::_write", result);
+
+            if (!written) last_error_.store(result, std::memory_order_relaxed);
+
+            write_ns_.fetch_add(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count()), std::memory_order_relaxed);
+
+            (written ? written_ : failed_).fetch_add(1, std::memory_order_relaxed);
+            reopens_.store(session_.reopen_count(), std::memory_order_relaxed);
+
+            return written;
+        }
+
+        /// counted per report like single writes, a failing batch counts every report in it as failed
+        template<std::size_t Capacity>
+        bool _write(report_batch<Capacity> const &batch) noexcept {
+            auto const start = std::chrono::steady_clock::now();
+            io_result_t const result = session_.send(batch);
+            bool const written = _try("report_writer::_write", result);
+
+            if (!written) last_error_.store(result, std::memory_order_relaxed);
+
+            write_ns_.fetch_add(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count()), std::memory_order_relaxed);
+
+            (written ? written_ : failed_).fetch_add(batch.size(), std::memory_order_relaxed);
+            reopens_.store(session_.reopen_count(), std::memory_order_relaxed);
+
+            return written;
+        }
+
+        void _wake() noexcept {
+            signal_.fetch_add(1, std::memory_order_release);
+            signal_.notify_one();
+        }
+
+        /// moves everything the producer queued into the scheduler, reports without a slot are written right away
+        void _collect() noexcept {
+            report rep;
+            std::uint32_t coalesced{0};
+
+            while (ring_.pop(rep)) {
+                if (!scheduler_.add(rep, coalesced)) _write(rep);
+            }
+
+            if (coalesced) coalesced_.fetch_add(coalesced, std::memory_order_relaxed);
+
+            scheduled_.store(scheduler_.size(), std::memory_order_relaxed);
+            scheduler_.set_interval(std::chrono::nanoseconds(write_interval_ns_.load(std::memory_order_relaxed)));
+        }
+
+        void _run() noexcept {
+            report rep;
+
+            for (;;) {
+                std::uint32_t const signal = signal_.load(std::memory_order_acquire);
+
+                _collect();
+
+                if (!scheduler_.empty()) {
+                    auto const now = report_scheduler::clock::now();
+
+                    // reports queued while waiting out the interval compete for the next write
+                    if (now < scheduler_.ready_at()) {
+                        std::this_thread::sleep_until(scheduler_.ready_at());
+                        continue;
+                    }
+
+                    if (scheduler_.pop(rep, now)) _write(rep);
+                    scheduled_.store(scheduler_.size(), std::memory_order_relaxed);
+                    continue;
+                }
+
+                if (!running() && ring_.empty()) break;
+
+                parked_.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                if (ring_.empty() && running()) signal_.wait(signal, std::memory_order_acquire);
+
+                parked_.store(false, std::memory_order_relaxed);
+            }
+        }
+    };
+}
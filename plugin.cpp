@@ -2,9 +2,17 @@
 #include <cassert>
 #include <cstdarg>
 #include <cstring>
+#include <cstdio>
 #include <cmath>
+#include <atomic>
+#include <chrono>
 #include <algorithm>
 #include <tuple>
+#include <utility>
+#include <optional>
+#include <string>
+#include <variant>
+#include <dlfcn.h>
 #include <scssdk_telemetry.h>
 #include <eurotrucks2/scssdk_eut2.h>
 #include <eurotrucks2/scssdk_telemetry_eut2.h>
@@ -12,93 +20,158 @@
 #include <amtrucks/scssdk_telemetry_ats.h>
 #include <g923mac/device.hpp>
 #include <g923mac/wheel.hpp>
+#include <g923mac/loop.hpp>
+#include <g923mac/calibration.hpp>
+#include <g923mac/hotplug.hpp>
+#include <g923mac/telemetry.hpp>
+#include <g923mac/forces.hpp>
+#include <g923mac/profile.hpp>
+#include <g923mac/truck.hpp>
+#include <g923mac/predictor.hpp>
+#include <g923mac/rate.hpp>
+#include <g923mac/timing.hpp>
+#include <g923mac/log_queue.hpp>
 #include <g923mac/force_feedback_config.hpp>
 
-bool g_telemetry_paused{true};
+std::atomic<bool> g_telemetry_paused{true};
 scs_timestamp_t g_last_timestamp{static_cast<scs_timestamp_t>(-1)};
 
-struct telemetry_state_t {
-    scs_timestamp_t timestamp;
-    scs_timestamp_t raw_rendering_timestamp;
-    scs_timestamp_t raw_simulation_timestamp;
-    scs_timestamp_t raw_paused_simulation_timestamp;
-
-    bool orientation_available;
-
-    float heading;
-    float pitch;
-    float roll;
-
-    float steering;
-    float input_steering;
-    float throttle;
-    float brake;
-    float clutch;
-
-    float speed;
-    float rpm;
-    int gear;
-
-    float linear_velocity_x; // lateral velocity
-    float linear_velocity_y; // vertical velocity
-    float linear_velocity_z; // longitudinal velocity
-    float angular_velocity_x; // roll rate
-    float angular_velocity_y; // pitch rate
-    float angular_velocity_z; // yaw rate
-    float linear_acceleration_x; // lateral acceleration
-    float linear_acceleration_y; // vertical acceleration
-    float linear_acceleration_z; // longitudinal acceleration
-    float angular_acceleration_x; // roll acceleration
-    float angular_acceleration_y; // pitch acceleration
-    float angular_acceleration_z; // yaw acceleration
-
-    bool parking_brake;
-    bool motor_brake;
-    std::uint32_t retarder_level;
-    float brake_air_pressure;
-    float cruise_control;
-    float fuel_amount;
-    bool engine_enabled;
-
-    float last_vertical_acceleration;
-    float terrain_impact_timer;
-    float terrain_smoothed_roughness;
-};
+using telemetry_state_t = g923mac::telemetry_state_t;
 
-telemetry_state_t g_telemetry_state;
+telemetry_state_t g_telemetry_state; // staging copy, only touched by the game thread callbacks
+g923mac::telemetry_snapshot g_telemetry_snapshot;
+g923mac::fixed_rate_loop g_force_loop;
+g923mac::rate_controller g_rate_controller;
+g923mac::frame_timing g_frame_timing; // game thread only
 scs_log_t g_game_log{nullptr};
-g923mac::vector<g923mac::wheel> g_wheels{};
+g923mac::log_queue<> g_deferred_log; // worker threads post here, the game thread writes it to g_game_log
+g923mac::vector<g923mac::any_wheel> g_wheels{}; // written by g_calibration when it turns ready, then the force loop's
+g923mac::calibration_worker<g923mac::any_wheel> g_calibration;
+std::optional<g923mac::device_manager> g_devices; // kept across sdk reinit, its device list stays cached
+g923mac::hotplug_monitor<g923mac::any_wheel> g_hotplug; // owns g_devices while running
 
-struct terrain_state_t {
-    float smoothed_roughness;
-    float impact_timer;
-    float last_vertical_accel;
-    float impact_cooldown;
-};
+using terrain_state_t = g923mac::terrain_state_t;
+using force_feedback_params_t = g923mac::force_feedback_params_t;
 
 terrain_state_t g_terrain_state{};
+g923mac::force_pipeline g_force_pipeline; // force loop only
+g923mac::profile_store g_profiles; // read by the force loop, written through g_tuned_profiles
+g923mac::tuned_profiles g_tuned_profiles{g_profiles};
+g923mac::profile_watcher g_profile_watcher;
+g923mac::truck_config g_truck{}; // game thread only, the truck g_tuned_profiles is tuned for
+scs_timestamp_t g_step_timestamp{0}; // force loop only, the frame simulation_step last saw
+g923mac::motion_predictor<> g_predictor; // force loop only
+g923mac::fixed_rate_loop::clock::time_point g_frame_seen{}; // when g_predictor last observed a new frame
+
+/// write totals summed over the wheels, what a rate window is measured against
+struct write_totals {
+    std::uint64_t writes;
+    std::uint64_t write_ns;
+};
+
+g923mac::fixed_rate_loop::clock::time_point g_next_rate_window{}; // force loop only
+write_totals g_rate_baseline{0, 0}; // the totals at the start of the current rate window
+g923mac::vector<g923mac::motion_sample> g_motion_recording{}; // only filled with ffb_config::prediction_evaluation
+
+// runs on the wheel's own calibration thread
+bool calibrate_wheel(g923mac::any_wheel &wheel, g923mac::calibration_options const &options) {
+    if (!std::visit([ & ](auto &w) { return w.calibrate(options); }, wheel)) {
+        if (!options.cancel->load(std::memory_order_relaxed)) {
+            g_deferred_log.post(SCS_LOG_TYPE_warning, "g923mac::warning : failed initializing device");
+        }
+        return false;
+    }
 
-bool init_wheels() {
-    g923mac::device_manager manager;
-    g923mac::vector<g923mac::hid_device> wheels = manager.find_known_wheels();
+    g_deferred_log.post(SCS_LOG_TYPE_message, "g923mac::info : wheel initialized");
+    std::visit([](auto &w) { w.start_writer(g923mac::overflow_policy::latest_wins); }, wheel);
+    return true;
+}
+
+// runs on the calibration worker once every wheel has finished or timed out, before the force loop sees any of them
+void publish_wheels(g923mac::vector<g923mac::any_wheel> &&calibrated) {
+    g_wheels = std::move(calibrated);
+
+    if (std::size_t const timed_out = g_calibration.timed_out(); timed_out > 0) {
+        char message[128];
+
+        snprintf(message, sizeof(message), "g923mac::warning : %zu wheel(s) did not finish calibrating in %d ms",
+                 timed_out, g923mac::ffb_config::calibration_timeout_ms);
+        g_deferred_log.post(SCS_LOG_TYPE_warning, message);
+    }
+}
+
+// runs on the hot-plug monitor, and on the game thread for the wheels attached at startup
+std::optional<g923mac::any_wheel> make_wheel(g923mac::hid_device const &device) {
+    std::optional<g923mac::any_wheel> wheel = g923mac::make_wheel(device);
+
+    if (!wheel) g_deferred_log.post(SCS_LOG_TYPE_warning, "g923mac::warning : no protocol for device");
+    return wheel;
+}
+
+/// calibrates the wheels attached now, then keeps watching for wheels plugged in or pulled out
+void init_wheels() {
+    using config = g923mac::ffb_config;
+
+    if (!g_devices) g_devices.emplace();
+
+    g923mac::vector<g923mac::hid_device> devices = g_devices->find_known_wheels();
+    g923mac::vector<g923mac::any_wheel> wheels;
 
     g_wheels.clear();
 
-    for (auto const &device: wheels) {
-        g923mac::wheel wheel(device);
+    for (auto const &device: devices) {
+        if (std::optional<g923mac::any_wheel> wheel = make_wheel(device)) wheels.push_back(std::move(*wheel));
+    }
 
-        if (!wheel.calibrate()) {
-            g_game_log(SCS_LOG_TYPE_warning, "g923mac::warning : failed initializing device");
-        } else {
-            g_game_log(SCS_LOG_TYPE_message, "g923mac::info : wheel initialized");
-            g_wheels.emplace_back(device);
-        }
+    if (wheels.empty()) {
+        g_game_log(SCS_LOG_TYPE_message, "g923mac::info : no wheel found, waiting for one to be plugged in");
+    }
+
+    g_calibration.start(std::move(wheels), config::calibration_led_sweep,
+                        std::chrono::milliseconds(config::calibration_timeout_ms), calibrate_wheel,
+                        publish_wheels);
+    g_hotplug.start(*g_devices, devices, std::chrono::milliseconds(config::hotplug_poll_interval_ms),
+                    config::calibration_led_sweep, std::chrono::milliseconds(config::calibration_timeout_ms),
+                    make_wheel, calibrate_wheel);
+}
+
+/// the force profile sits next to the plugin library
+std::string profile_path() {
+    Dl_info info{};
+    std::string directory;
+
+    if (dladdr(&g_profiles, &info) != 0 && info.dli_fname != nullptr) {
+        directory = info.dli_fname;
+        directory.erase(directory.find_last_of('/') + 1);
     }
+    return directory + g923mac::ffb_config::profile_file_name;
+}
 
-    return !g_wheels.empty();
+// runs on the profile watcher, and on the game thread for the load at startup
+void report_profile(g923mac::profile_parse_result const &result) {
+    char message[512];
+    char const *const path = g_profile_watcher.path().c_str();
+
+    switch (result.error) {
+        case g923mac::profile_error::none:
+            snprintf(message, sizeof(message), "g923mac::info : force profile %s loaded, %zu knob(s) set", path,
+                     result.knobs);
+            g_deferred_log.post(SCS_LOG_TYPE_message, message);
+            break;
+        case g923mac::profile_error::missing:
+            snprintf(message, sizeof(message), "g923mac::info : no force profile at %s, using the defaults", path);
+            g_deferred_log.post(SCS_LOG_TYPE_message, message);
+            break;
+        default:
+            snprintf(message, sizeof(message), "g923mac::warning : force profile %s line %zu: %s, keeping the "
+                     "previous profile", path, result.line, g923mac::profile_error_name(result.error));
+            g_deferred_log.post(SCS_LOG_TYPE_warning, message);
+            break;
+    }
 }
 
-bool update_leds(g923mac::wheel &wheel, float rpm, float speed, float brake, bool parking_brake) {
+template<typename Wheel>
+bool update_leds(Wheel &wheel, float rpm, float speed, float brake, bool parking_brake) {
     static constexpr std::uint8_t led_0{0x00};
     static constexpr std::uint8_t led_1{0x01};
     static constexpr std::uint8_t led_2{0x03};
@@ -169,375 +242,444 @@ std::tuple<std::uint8_t, std::uint8_t> calculate_resonance_params(float speed, f
     return std::tuple{amplitude, frequency};
 }
 
-struct force_feedback_params_t {
-    std::uint8_t autocenter_force;
-    std::uint8_t autocenter_slope;
-    std::uint8_t damper_force_pos;
-    std::uint8_t damper_force_neg;
-    std::uint8_t constant_force;
-    bool use_constant_force;
-    std::uint8_t spring_k1;
-    std::uint8_t spring_k2;
-    std::uint8_t spring_clip;
-    bool use_custom_spring;
-};
+/// `dt` is the simulation time (s) since the previous call, zero when no new frame arrived since
+g923mac::force_mix calculate_enhanced_forces(telemetry_state_t const &telemetry, float dt) {
+    g923mac::force_context context{telemetry, dt, g_terrain_state, g_profiles.acquire()};
 
-force_feedback_params_t calculate_enhanced_forces(telemetry_state_t const &telemetry) {
-    force_feedback_params_t params{};
+    g_force_pipeline.run(context);
 
-    using config = g923mac::ffb_config;
+    return context.mix;
+}
 
-    float const speed_kmh = telemetry.speed * 3.6f; // Convert m/s to km/h
-    float const abs_speed = std::abs(telemetry.speed);
-    float const effective_steering = telemetry.steering;
-    float const lateral_g = telemetry.linear_acceleration_x / 9.81f;
-    float const vertical_acceleration = telemetry.linear_acceleration_y;
-    float const abs_vertical_accel = std::abs(vertical_acceleration);
 
-    // Detect sudden impacts (curbs, potholes, road edges) - only use vertical acceleration for terrain detection
-    float const accel_change = std::abs(vertical_acceleration - g_terrain_state.last_vertical_accel);
+std::uint8_t calculate_damper_force(float speed, float rpm) {
+    if (rpm != 0) return 0;
 
-    // Filtering to avoid normal driving vibrations
-    bool const is_high_speed = abs_speed > 40.0f;
-    bool const is_turning = std::abs(telemetry.angular_velocity_y) > 0.1f;
-    bool const is_accelerating = std::abs(telemetry.linear_acceleration_z) > 1.0f;
-    float impact_threshold = config::terrain_minor_threshold * 5.0f;
+    if (speed < 1) { return 3; } else if (speed < 5) { return 2; } else if (speed < 45) { return 1; } else if (
+        speed < 75) { return 1; } else { return 0; }
+}
 
-    if (is_high_speed) {
-        impact_threshold *= 3.0f;
-    }
-    if (is_turning) {
-        impact_threshold *= 2.5f;
-    }
-    if (is_accelerating) {
-        impact_threshold *= 2.0f;
+std::tuple<std::uint8_t, std::uint8_t> calculate_autocentering_force(float speed) {
+    std::uint8_t force;
+    std::uint8_t slope;
+
+    if (speed < 1) {
+        force = 0;
+        slope = 0;
+    } else {
+        if (speed < 5) { slope = 2; } else if (speed < 45) { slope = 2; } else if (speed < 75) { slope = 3; } else {
+            slope = 4;
+        }
+
+        force = speed * speed / 2000.0f * 255;
+
+        if (force < 24) force = 24;
+        if (force > 64) force = 64;
     }
+    return std::tuple{slope, force};
+}
+
+/// a failing wheel fails on every tick, so only its change of state is logged
+template<typename Wheel>
+void report_wheel_state(Wheel const &wheel, g923mac::wheel_state before) {
+    using enum g923mac::wheel_state;
+
+    if (wheel.state() == before) return;
 
-    bool const sudden_impact = (accel_change > impact_threshold) && // Must exceed dynamic threshold AND
-                               ((abs_vertical_accel > (impact_threshold * 2.0f)) ||
-                                // High upward/downward acceleration OR
-                                (std::abs(vertical_acceleration - g_terrain_state.last_vertical_accel) > (
-                                     impact_threshold * 1.5f))) && // Significant change from last frame AND
-                               (accel_change > 0.12f); // Must be a significant change (0.12G minimum)
+    char message[128];
+    bool const failing = wheel.state() == faulted || wheel.state() == disconnected;
 
-    float current_roughness = abs_vertical_accel / 9.81f;
-    g_terrain_state.smoothed_roughness = g_terrain_state.smoothed_roughness * config::terrain_smoothing_factor +
-                                         current_roughness * (1.0f - config::terrain_smoothing_factor);
+    if (!failing && before != faulted && before != disconnected) return;
 
-    bool const on_minor_bump = current_roughness > (config::terrain_minor_threshold * 3.0f);
-    bool const on_rough_terrain = g_terrain_state.smoothed_roughness > (config::terrain_detection_threshold * 3.0f);
-    bool const on_major_terrain = g_terrain_state.smoothed_roughness > (config::terrain_major_threshold * 2.0f);
+    snprintf(message, sizeof(message), "g923mac::%s : wheel %08x %s, was %s", failing ? "error" : "info",
+             wheel.device_id(), g923mac::wheel_state_name(wheel.state()), g923mac::wheel_state_name(before));
+    g_deferred_log.post(failing ? SCS_LOG_TYPE_error : SCS_LOG_TYPE_message, message);
+}
+
+template<typename Wheel>
+bool update_wheel_forces(Wheel &wheel, force_feedback_params_t const &params) {
+    g923mac::effect_set effects;
+    g923mac::report_batch<> batch;
 
-    // Only detect new impacts if not in cooldown period
-    if (sudden_impact && abs_speed > 3.0f && g_terrain_state.impact_cooldown <= 0.0f) {
-        g_terrain_state.impact_timer = config::terrain_impact_duration * 0.25f;
-        g_terrain_state.impact_cooldown = 0.6f;
+    using enum g923mac::force_channel;
+
+    if (params.use_constant_force) {
+        effects.play(wheel.make_constant_force(params[constant_force]));
     }
 
-    if (g_terrain_state.impact_timer > 0.0f) {
-        g_terrain_state.impact_timer -= 1.0f / 60.0f;
-        g_terrain_state.impact_timer = std::max(0.0f, g_terrain_state.impact_timer);
+    if (params.use_custom_spring) {
+        effects.play(wheel.make_custom_spring(0, 0, params[spring_k1], params[spring_k2],
+                                              0, 0, params[spring_clip]));
     }
 
-    if (g_terrain_state.impact_cooldown > 0.0f) {
-        g_terrain_state.impact_cooldown -= 1.0f / 60.0f;
-        g_terrain_state.impact_cooldown = std::max(0.0f, g_terrain_state.impact_cooldown);
+    if (params[damper_pos] > 0 || params[damper_neg] > 0) {
+        effects.play(wheel.make_damper(params[damper_pos], params[damper_neg], 0, 0));
     }
 
-    float self_align_torque = 0.0f;
-    if (abs_speed > config::speed_stationary_threshold) {
-        self_align_torque = abs_speed * config::sat_base_torque_factor * std::abs(effective_steering);
+    wheel.stage_effects(effects, batch);
 
-        if (speed_kmh > config::sat_speed_reduction_start) {
-            float speed_factor = 1.0f - ((speed_kmh - config::sat_speed_reduction_start) /
-                                         config::sat_speed_reduction_range);
-            self_align_torque *= std::max(config::sat_min_factor, speed_factor);
+    if (!params.use_constant_force) {
+        if (params[autocenter_force] > 0) {
+            batch.push(wheel.make_enable_autocenter());
+            batch.push(wheel.make_autocenter_spring(params[autocenter_slope], params[autocenter_slope],
+                                                    params[autocenter_force]));
+        } else {
+            batch.push(wheel.make_disable_autocenter());
         }
-
-        float lateral_factor = 1.0f - std::min(config::sat_max_lateral_reduction,
-                                               std::abs(lateral_g) * config::sat_lateral_g_factor);
-        self_align_torque *= lateral_factor;
     }
 
-    float power_steering_multiplier = 1.0f;
-    if (telemetry.engine_enabled && telemetry.rpm > 500.0f) {
-        if (speed_kmh < 10.0f) {
-            power_steering_multiplier = 0.7f;
-        } else if (speed_kmh < 30.0f) {
-            power_steering_multiplier = 0.8f;
-        } else {
-            power_steering_multiplier = 0.9f;
-        }
-    } else {
-        if (speed_kmh < 10.0f) {
-            power_steering_multiplier = 2.0f;
-        } else if (speed_kmh < 30.0f) {
-            power_steering_multiplier = 1.6f;
-        } else {
-            power_steering_multiplier = 1.3f;
-        }
+    g923mac::wheel_state const before = wheel.state();
+    bool const sent = wheel.send(batch);
+
+    report_wheel_state(wheel, before);
+    return sent;
+}
+
+bool update_forces(g923mac::vector<g923mac::any_wheel> &wheels, telemetry_state_t const &telemetry, float dt) {
+    bool all_passed{true};
+
+    // every wheel plays the same mix, quantized once right before it is encoded
+    force_feedback_params_t const params = g923mac::quantize(calculate_enhanced_forces(telemetry, dt));
+
+    for (auto &wheel: wheels) {
+        if (!std::visit([ & ](auto &w) { return update_wheel_forces(w, params); }, wheel)) all_passed = false;
     }
 
-    float centering_multiplier = 1.0f;
-    if (telemetry.engine_enabled && telemetry.rpm > 500.0f) {
-        centering_multiplier = 0.7f;
-    } else {
-        centering_multiplier = 1.0f;
-    }
-
-    if (abs_speed < config::speed_stationary_threshold) {
-        params.autocenter_force = static_cast<std::uint8_t>(config::center_stationary_force * centering_multiplier);
-        params.autocenter_slope = static_cast<std::uint8_t>(config::center_stationary_slope);
-        params.damper_force_pos = static_cast<std::uint8_t>(config::damper_stationary_pos * power_steering_multiplier);
-        params.damper_force_neg = static_cast<std::uint8_t>(config::damper_stationary_neg * power_steering_multiplier);
-    } else if (speed_kmh < config::speed_low_threshold) {
-        params.autocenter_force = static_cast<std::uint8_t>(
-            (config::center_low_speed_base + speed_kmh * config::center_low_speed_factor) * centering_multiplier);
-        params.autocenter_slope = 2;
-        params.damper_force_pos = static_cast<std::uint8_t>(config::damper_low_speed * power_steering_multiplier);
-        params.damper_force_neg = static_cast<std::uint8_t>(config::damper_low_speed * power_steering_multiplier);
-    } else {
-        params.autocenter_force = static_cast<std::uint8_t>(
-            std::min(config::center_max_force,
-                     (config::center_highway_base + self_align_torque * config::center_highway_factor) *
-                     centering_multiplier));
-
-        if (speed_kmh < config::speed_medium_threshold) params.autocenter_slope = 2;
-        else if (speed_kmh < config::speed_high_threshold) params.autocenter_slope = 3;
-        else if (speed_kmh < config::speed_very_high_threshold) params.autocenter_slope = 4;
-        else params.autocenter_slope = 5;
-
-        std::uint8_t base_damper = static_cast<std::uint8_t>(
-            std::min(config::damper_max, (1.0f + speed_kmh / config::damper_speed_factor) * power_steering_multiplier));
-        params.damper_force_pos = base_damper;
-        params.damper_force_neg = base_damper;
-    }
-
-    if (telemetry.motor_brake || telemetry.retarder_level > 0) {
-        float brake_factor = config::damper_brake_factor + (telemetry.retarder_level * config::damper_retarder_factor);
-        if (telemetry.motor_brake) brake_factor += config::damper_engine_brake_factor;
-
-        params.damper_force_pos = static_cast<std::uint8_t>(
-            std::min(config::damper_max_total, params.damper_force_pos * brake_factor));
-        params.damper_force_neg = static_cast<std::uint8_t>(
-            std::min(config::damper_max_total, params.damper_force_neg * brake_factor));
-    }
-
-    float const yaw_rate = telemetry.angular_velocity_z;
-    if (std::abs(yaw_rate) > config::yaw_rate_threshold && abs_speed > 5.0f) {
-        // Add understeer/oversteer effects
-        float yaw_factor = std::min(config::yaw_max_factor, std::abs(yaw_rate) * config::yaw_rate_factor);
-
-        if ((yaw_rate > 0 && effective_steering > 0) || (yaw_rate < 0 && effective_steering < 0)) {
-            // Oversteer
-            params.autocenter_force = static_cast<std::uint8_t>(
-                params.autocenter_force * (1.0f - yaw_factor * config::oversteer_reduction));
-            params.damper_force_pos += static_cast<std::uint8_t>(yaw_factor * config::oversteer_damping_add);
-            params.damper_force_neg += static_cast<std::uint8_t>(yaw_factor * config::oversteer_damping_add);
-        } else {
-            // Understeer
-            params.autocenter_force = static_cast<std::uint8_t>(
-                std::min(80.0f, params.autocenter_force * (1.0f + yaw_factor * config::understeer_factor)));
+    return all_passed;
+}
+
+/// simulation time (s) between the frame seen on the previous call and this one, zero if it is the same frame
+float simulation_step(telemetry_state_t const &telemetry) {
+    using config = g923mac::ffb_config;
+
+    scs_timestamp_t const timestamp = telemetry.timestamp;
+    float const dt = timestamp > g_step_timestamp ? static_cast<float>(timestamp - g_step_timestamp) * 1e-6f : 0.0f;
+    g_step_timestamp = timestamp;
+
+    return std::min(dt, config::effect_max_step);
+}
+
+/// the frame with steering, yaw rate and lateral acceleration moved forward by the lookahead
+/// plus the time the frame has already been waiting for the next one; a frame older than the longest lookahead
+/// is passed through as it is
+telemetry_state_t predict_motion(telemetry_state_t const &telemetry, float dt,
+                                 g923mac::fixed_rate_loop::clock::time_point now) {
+    using config = g923mac::ffb_config;
+
+    if (dt > 0.0f) {
+        g923mac::motion_sample const sample{
+            static_cast<double>(telemetry.timestamp) * 1e-6, telemetry.steering, telemetry.angular_velocity_z,
+            telemetry.angular_acceleration_z, telemetry.linear_acceleration_x
+        };
+
+        g_predictor.observe(sample);
+        g_frame_seen = now;
+
+        if (config::prediction_evaluation && g_motion_recording.size() < g_motion_recording.capacity()) {
+            g_motion_recording.push_back(sample);
         }
     }
 
-    float terrain_force_multiplier = 1.0f;
-    float terrain_damping_add = 0.0f;
-    bool use_terrain_spring = false;
-    std::uint8_t terrain_spring_intensity = 0;
+    if (config::prediction_lookahead <= 0.0f || g_predictor.size() == 0) return telemetry;
 
-    // Sudden impact effects (curbs, potholes, road edges)
-    if (g_terrain_state.impact_timer > 0.0f) {
-        float impact_intensity = g_terrain_state.impact_timer / (config::terrain_impact_duration * 0.3f);
-        terrain_force_multiplier += impact_intensity * 1.0f;
-        terrain_damping_add += impact_intensity * 2.0f;
+    float const age = std::chrono::duration<float>(now - g_frame_seen).count();
+    if (age > config::prediction_max_lookahead) return telemetry;
 
-        use_terrain_spring = true;
-        terrain_spring_intensity = static_cast<std::uint8_t>(
-            std::min(12.0f, impact_intensity * 20.0f));
-    }
-    // Minor bumps and surface variations
-    else if (on_minor_bump && abs_speed > 12.0f) {
-        terrain_force_multiplier += current_roughness * 1.0f;
-        terrain_damping_add += current_roughness * 0.8f;
+    g923mac::motion_state const motion = g_predictor.predict(
+        std::min(config::prediction_max_lookahead, config::prediction_lookahead + age));
+
+    telemetry_state_t predicted = telemetry;
+    predicted.steering = motion.steering;
+    predicted.angular_velocity_z = motion.yaw_rate;
+    predicted.linear_acceleration_x = motion.lateral_accel;
 
-        use_terrain_spring = true;
-        terrain_spring_intensity = static_cast<std::uint8_t>(
-            std::min(4.0f, 1.0f + current_roughness * 3.0f));
+    return predicted;
+}
+
+write_totals sum_write_totals() {
+    write_totals totals{0, 0};
+
+    for (auto const &wheel: g_wheels) {
+        std::visit([ & ](auto const &w) {
+            g923mac::writer_stats const stats = w.stats();
+
+            totals.writes += stats.written + stats.failed;
+            totals.write_ns += stats.write_ns;
+        }, wheel);
     }
-    // Continuous rough terrain (dirt roads, gravel)
-    else if (on_rough_terrain && abs_speed > 8.0f) {
-        if (on_major_terrain) {
-            terrain_force_multiplier = 1.0f + config::terrain_offroad_multiplier * 0.1f;
-            terrain_damping_add = g_terrain_state.smoothed_roughness * 0.8f;
-        } else {
-            terrain_force_multiplier = 1.0f + g_terrain_state.smoothed_roughness * 0.5f;
-            terrain_damping_add = g_terrain_state.smoothed_roughness * 0.4f;
-        }
+    return totals;
+}
 
-        use_terrain_spring = true;
-        terrain_spring_intensity = static_cast<std::uint8_t>(
-            std::min(3.0f, 0.5f + g_terrain_state.smoothed_roughness * 2.0f));
+/// once per window, measures how the wheels' transports keep up and adapts the loop rate and write spacing
+void adapt_force_rate(g923mac::fixed_rate_loop::clock::time_point now) {
+    using config = g923mac::ffb_config;
+
+    if (now < g_next_rate_window) return;
+    g_next_rate_window = now + std::chrono::milliseconds(config::rate_window_ms);
+
+    write_totals const totals = sum_write_totals();
+    std::size_t backlog{0};
+
+    for (auto const &wheel: g_wheels) {
+        std::visit([ & ](auto const &w) { backlog = std::max(backlog, w.backlog()); }, wheel);
     }
 
-    if (terrain_force_multiplier > 1.0f || terrain_damping_add > 0.0f) {
-        params.autocenter_force = static_cast<std::uint8_t>(
-            std::min(80.0f, params.autocenter_force * terrain_force_multiplier));
+    std::uint64_t const window_writes = totals.writes - g_rate_baseline.writes;
+    std::uint64_t const window_ns = totals.write_ns - g_rate_baseline.write_ns;
+    g_rate_baseline = totals;
+
+    g923mac::backpressure_sample const sample{
+        std::chrono::nanoseconds(window_writes ? window_ns / window_writes : 0), backlog
+    };
+    g923mac::rate_reason reason;
+
+    if (!g_rate_controller.update(sample, reason)) return;
 
-        params.damper_force_pos = static_cast<std::uint8_t>(
-            std::min(8.0f, params.damper_force_pos + terrain_damping_add));
-        params.damper_force_neg = static_cast<std::uint8_t>(
-            std::min(8.0f, params.damper_force_neg + terrain_damping_add));
+    g_force_loop.set_period(g923mac::period_of(g_rate_controller.rate_hz()));
+
+    for (auto &wheel: g_wheels) {
+        std::visit([ & ](auto &w) { w.set_write_interval(g_rate_controller.write_interval()); }, wheel);
     }
+}
+
+void update_wheels(telemetry_state_t const &telemetry, g923mac::fixed_rate_loop::clock::time_point now) {
+    using config = g923mac::ffb_config;
+
+    static g923mac::fixed_rate_loop::clock::time_point next_led_update{};
+
+    float const dt = simulation_step(telemetry);
 
-    if (use_terrain_spring) {
-        params.use_custom_spring = true;
-        params.spring_k1 = terrain_spring_intensity;
-        params.spring_k2 = terrain_spring_intensity;
-        params.spring_clip = static_cast<std::uint8_t>(20 + terrain_spring_intensity * 8);
+    // failures are logged per wheel as it changes state
+    if (!update_forces(g_wheels, predict_motion(telemetry, dt, now), dt)) return;
+
+    g_terrain_state.last_vertical_accel = telemetry.linear_acceleration_y;
+
+    if (now >= next_led_update) {
+        for (auto &wheel: g_wheels) {
+            if (!std::visit([ & ](auto &w) {
+                g923mac::wheel_state const before = w.state();
+                bool const sent = update_leds(w, telemetry.rpm, telemetry.speed, telemetry.brake,
+                                              telemetry.parking_brake);
+
+                report_wheel_state(w, before);
+                return sent;
+            }, wheel)) {
+                g_deferred_log.post(SCS_LOG_TYPE_warning, "g923mac::warning : LED update failed");
+            }
+        }
+        next_led_update = now + g923mac::period_of(config::led_update_hz);
     }
 
-    float const steering_rate = std::abs(telemetry.angular_acceleration_z);
-    if (steering_rate > config::kickback_threshold && abs_speed > config::kickback_speed_threshold && !params.
-        use_constant_force) {
-        // Sudden steering inputs create momentary force feedback
-        params.use_constant_force = true;
-        params.constant_force = static_cast<std::uint8_t>(
-            std::min(config::kickback_max_force, steering_rate * config::kickback_factor));
+    adapt_force_rate(now);
+}
+
+// each wheel stops its effects once on entering pause and stays silent until resumed
+bool pause_wheels() {
+    bool succ{true};
+
+    for (auto &wheel: g_wheels) {
+        std::visit([ & ](auto &w) {
+            if (!w.pause()) succ = false;
+        }, wheel);
     }
+    return succ;
+}
 
-    // Parking brake - lock steering
-    if (telemetry.parking_brake) {
-        params.autocenter_force = static_cast<std::uint8_t>(config::parking_brake_force);
-        params.autocenter_slope = static_cast<std::uint8_t>(config::parking_brake_slope);
-        params.damper_force_pos = static_cast<std::uint8_t>(config::parking_brake_damper);
-        params.damper_force_neg = static_cast<std::uint8_t>(config::parking_brake_damper);
+void resume_wheels() {
+    for (auto &wheel: g_wheels) {
+        std::visit([ & ](auto &w) { w.resume(); }, wheel);
     }
+}
 
-    return params;
+void log_wheel_stats() {
+    char message[256];
+
+    for (auto const &any: g_wheels) {
+        std::visit([ & ](auto const &wheel) {
+            g923mac::writer_stats const stats = wheel.stats();
+
+            snprintf(message, sizeof(message),
+                     "g923mac::info : wheel %08x suppressed %llu, enqueued %llu, dropped %llu, coalesced %llu, "
+                     "written %llu, failed %llu, session reopened %u times, %s", wheel.device_id(),
+                     static_cast<unsigned long long>(wheel.suppressed_reports()),
+                     static_cast<unsigned long long>(stats.enqueued),
+                     static_cast<unsigned long long>(stats.dropped), static_cast<unsigned long long>(stats.coalesced),
+                     static_cast<unsigned long long>(stats.written), static_cast<unsigned long long>(stats.failed),
+                     stats.reopens, g923mac::wheel_state_name(wheel.state()));
+            g_game_log(SCS_LOG_TYPE_message, message);
+        }, any);
+    }
 }
 
+void log_force_loop_stats() {
+    using reason = g923mac::rate_reason;
+
+    char message[256];
+
+    snprintf(message, sizeof(message), "g923mac::info : force loop ran %llu ticks, %llu deadlines missed",
+             static_cast<unsigned long long>(g_force_loop.ticks()),
+             static_cast<unsigned long long>(g_force_loop.overruns()));
+    g_game_log(SCS_LOG_TYPE_message, message);
+
+    snprintf(message, sizeof(message),
+             "g923mac::info : force rate %d Hz, write interval %lld us, backed off %llu times for %s and %llu for %s, "
+             "sped up %llu times", g_rate_controller.rate_hz(),
+             static_cast<long long>(g_rate_controller.write_interval().count()),
+             static_cast<unsigned long long>(g_rate_controller.adjustments(reason::write_latency)),
+             g923mac::rate_reason_name(reason::write_latency),
+             static_cast<unsigned long long>(g_rate_controller.adjustments(reason::backlog)),
+             g923mac::rate_reason_name(reason::backlog),
+             static_cast<unsigned long long>(g_rate_controller.adjustments(reason::recovered)));
+    g_game_log(SCS_LOG_TYPE_message, message);
+}
 
-std::uint8_t calculate_damper_force(float speed, float rpm) {
-    if (rpm != 0) return 0;
+void log_prediction_error(char const *signal, g923mac::prediction_error const &predicted,
+                          g923mac::prediction_error const &held) {
+    char message[256];
 
-    if (speed < 1) { return 3; } else if (speed < 5) { return 2; } else if (speed < 45) { return 1; } else if (
-        speed < 75) { return 1; } else { return 0; }
+    snprintf(message, sizeof(message),
+             "g923mac::info : prediction %s: rms %.4f max %.4f, holding the last frame rms %.4f max %.4f",
+             signal, predicted.rms, predicted.max, held.rms, held.max);
+    g_game_log(SCS_LOG_TYPE_message, message);
 }
 
-std::tuple<std::uint8_t, std::uint8_t> calculate_autocentering_force(float speed) {
-    std::uint8_t force;
-    std::uint8_t slope;
+/// replays the frames recorded this session through the predictor
+void log_prediction_evaluation() {
+    using config = g923mac::ffb_config;
 
-    if (speed < 1) {
-        force = 0;
-        slope = 0;
-    } else {
-        if (speed < 5) { slope = 2; } else if (speed < 45) { slope = 2; } else if (speed < 75) { slope = 3; } else {
-            slope = 4;
-        }
+    if (!config::prediction_evaluation) return;
 
-        force = speed * speed / 2000.0f * 255;
+    g923mac::prediction_report const report = g923mac::evaluate_predictions(
+        g_motion_recording.data(), g_motion_recording.size(), config::prediction_lookahead);
 
-        if (force < 24) force = 24;
-        if (force > 64) force = 64;
-    }
-    return std::tuple{slope, force};
+    char message[128];
+    snprintf(message, sizeof(message), "g923mac::info : prediction evaluated over %zu frames, lookahead %.0f ms",
+             report.evaluated, static_cast<double>(config::prediction_lookahead) * 1000.0);
+    g_game_log(SCS_LOG_TYPE_message, message);
+
+    log_prediction_error("steering", report.steering, report.steering_hold);
+    log_prediction_error("yaw rate", report.yaw_rate, report.yaw_rate_hold);
+    log_prediction_error("lateral accel", report.lateral_accel, report.lateral_accel_hold);
 }
 
-bool update_forces(g923mac::vector<g923mac::wheel> &wheels, telemetry_state_t const &telemetry) {
-    bool all_passed{true};
+void log_rolling_summary(char const *series, char const *unit, g923mac::rolling_summary const &summary) {
+    char message[256];
 
-    force_feedback_params_t const params = calculate_enhanced_forces(telemetry);
+    snprintf(message, sizeof(message),
+             "g923mac::info : %s over the last %zu frames: p50 %llu %s, p90 %llu %s, p99 %llu %s, max %llu %s",
+             series, summary.count, static_cast<unsigned long long>(summary.p50), unit,
+             static_cast<unsigned long long>(summary.p90), unit, static_cast<unsigned long long>(summary.p99), unit,
+             static_cast<unsigned long long>(summary.max), unit);
+    g_game_log(SCS_LOG_TYPE_message, message);
+}
 
-    for (auto &wheel: wheels) {
-        if (params.use_constant_force) {
-            if (!wheel.set_constant_force(params.constant_force)) {
-                g_game_log(SCS_LOG_TYPE_error, "g923mac : failed setting constant force");
-                all_passed = false;
-            }
-            continue;
-        } else {
-            wheel.stop_forces();
-        }
+/// game frame pacing and the share of each frame our frame_end callback takes, callable at any time
+void log_frame_timing() {
+    g923mac::rolling_summary const render = g_frame_timing.render_delta();
+    g923mac::rolling_summary const frame_end = g_frame_timing.frame_end_time();
 
-        if (params.use_custom_spring) {
-            if (!wheel.set_custom_spring(0, 0, params.spring_k1, params.spring_k2,
-                                         0, 0, params.spring_clip)) {
-                g_game_log(SCS_LOG_TYPE_error, "g923mac : failed setting custom spring");
-                all_passed = false;
-            }
-        }
+    log_rolling_summary("render delta", "us", render);
+    log_rolling_summary("simulation delta", "us", g_frame_timing.simulation_delta());
+    log_rolling_summary("render jitter", "us", g_frame_timing.render_jitter());
+    log_rolling_summary("frame_end time", "ns", frame_end);
 
-        if (params.damper_force_pos > 0 || params.damper_force_neg > 0) {
-            if (!wheel.set_damper(params.damper_force_pos, params.damper_force_neg, 0, 0)) {
-                g_game_log(SCS_LOG_TYPE_error, "g923mac : failed setting damper force");
-                all_passed = false;
-            }
-        }
+    if (render.p50 == 0) return;
 
-        if (params.autocenter_force > 0) {
-            if (!wheel.enable_autocenter() ||
-                !wheel.set_autocenter_spring(params.autocenter_slope, params.autocenter_slope,
-                                             params.autocenter_force)) {
-                g_game_log(SCS_LOG_TYPE_error, "g923mac : failed setting autocenter spring force");
-                all_passed = false;
-            }
-        } else {
-            if (!wheel.disable_autocenter()) {
-                g_game_log(SCS_LOG_TYPE_error, "g923mac : failed disabling autocenter spring");
-                all_passed = false;
-            }
-        }
-    }
+    char message[128];
+    snprintf(message, sizeof(message), "g923mac::info : frame_end takes %.4f%% of a median frame at p99",
+             static_cast<double>(frame_end.p99) / (static_cast<double>(render.p50) * 1000.0) * 100.0);
+    g_game_log(SCS_LOG_TYPE_message, message);
+}
 
-    return all_passed;
+/// what each force stage cost over the session, the dominant stage has the largest share
+void log_effect_stage_costs() {
+    std::uint64_t const total = g_force_pipeline.total_cycles();
+    char message[256];
+
+    for (std::size_t i = 0; i < g923mac::force_pipeline::size; ++i) {
+        g923mac::stage_stats const &stats = g_force_pipeline.stats(i);
+        std::uint64_t const ticks = stats.runs + stats.skips;
+
+        if (ticks == 0) continue;
+
+        snprintf(message, sizeof(message),
+                 "g923mac::info : force stage %s: applied %llu, skipped %llu, %.1f cycles per tick, %.1f%% of the "
+                 "pipeline", g923mac::force_pipeline::names[i], static_cast<unsigned long long>(stats.runs),
+                 static_cast<unsigned long long>(stats.skips),
+                 static_cast<double>(stats.cycles) / static_cast<double>(ticks),
+                 total ? static_cast<double>(stats.cycles) / static_cast<double>(total) * 100.0 : 0.0);
+        g_game_log(SCS_LOG_TYPE_message, message);
+    }
 }
 
-bool update_wheels(telemetry_state_t const &telemetry) {
-    using config = g923mac::ffb_config;
+void log_write_latencies() {
+    char message[256];
 
-    static std::int32_t ffb_rate{config::force_update_rate};
-    static std::int32_t ffb_rate_count{config::force_update_rate};
-    static std::int32_t led_rate{config::led_update_rate};
-    static std::int32_t led_rate_count{config::led_update_rate};
+    for (std::size_t i = 0; i < g923mac::command_metric_count; ++i) {
+        auto const metric = static_cast<g923mac::command_metric>(i);
+        g923mac::latency_summary const latency = g923mac::write_latencies().summary(metric);
 
-    --ffb_rate_count;
-    --led_rate_count;
+        if (latency.count == 0) continue;
 
-    if (ffb_rate_count == 0) {
-        if (!update_forces(g_wheels, telemetry)) {
-            g_game_log(SCS_LOG_TYPE_error, "g923mac::error : update_forces failed");
-            return false;
-        }
-        ffb_rate_count = ffb_rate;
+        snprintf(message, sizeof(message),
+                 "g923mac::info : write latency %s: %llu writes, p50 %.1f us, p99 %.1f us, p99.9 %.1f us, "
+                 "max %.1f us", g923mac::metric_name(metric), static_cast<unsigned long long>(latency.count),
+                 static_cast<double>(latency.p50_ns) / 1000.0, static_cast<double>(latency.p99_ns) / 1000.0,
+                 static_cast<double>(latency.p999_ns) / 1000.0, static_cast<double>(latency.max_ns) / 1000.0);
+        g_game_log(SCS_LOG_TYPE_message, message);
     }
+}
 
-    if (led_rate_count == 0) {
-        for (auto &wheel: g_wheels) {
-            if (!update_leds(wheel, telemetry.rpm, telemetry.speed,
-                             telemetry.brake, telemetry.parking_brake)) {
-                g_game_log(SCS_LOG_TYPE_warning, "g923mac::warning : LED update failed");
-            }
-        }
-        led_rate_count = led_rate;
+/// adds wheels that were plugged in and calibrated, drops wheels whose device is gone so nothing more is written
+/// to them; never waits on the hot-plug monitor, changes it is still posting are picked up next tick
+void take_hotplug_changes() {
+    g923mac::hotplug_changes const changes = g_hotplug.take(g_wheels, [](g923mac::any_wheel const &wheel) {
+        return std::visit([](auto const &w) { return w.device_ref(); }, wheel);
+    });
+
+    if (!changes) return;
+
+    for (auto &wheel: g_wheels) {
+        std::visit([](auto &w) { w.set_write_interval(g_rate_controller.write_interval()); }, wheel);
     }
 
-    return true;
+    // the totals of a removed wheel leave the sums, so the rate window starts over from what remains
+    if (changes.removed != 0) g_rate_baseline = sum_write_totals();
+
+    char message[128];
+    snprintf(message, sizeof(message), "g923mac::info : %zu wheel(s) plugged in, %zu pulled out, %zu active",
+             changes.added, changes.removed, g_wheels.size());
+    g_deferred_log.post(SCS_LOG_TYPE_message, message);
 }
 
-bool reset_wheels() {
-    bool succ{true};
+void flush_deferred_log() {
+    g_deferred_log.drain([](scs_log_type_t type, char const *message) { g_game_log(type, message); });
+}
 
-    for (auto &wheel: g_wheels) {
-        if (!wheel.stop_forces()) succ = false;
-        if (!wheel.disable_autocenter()) succ = false;
-        if (!update_leds(wheel, 0, 0, 0, false)) succ = false;
+/// the force loop is the only producer of reports once the wheels are initialized
+void force_loop_tick(g923mac::fixed_rate_loop::clock::time_point deadline) {
+    // forces stay off until every wheel has finished calibrating
+    if (!g_calibration.ready()) return;
+
+    take_hotplug_changes();
+
+    if (g_telemetry_paused.load(std::memory_order_acquire)) {
+        if (!pause_wheels()) {
+            g_deferred_log.post(SCS_LOG_TYPE_error, "g923mac::error : failed stopping forces!");
+        }
+        return;
     }
-    return succ;
+    resume_wheels();
+
+    telemetry_state_t const telemetry = g_telemetry_snapshot.load();
+
+    update_wheels(telemetry, deadline);
 }
 
 void deinit_wheels() {
+    g_force_loop.stop();
+    g_hotplug.stop();
+    g_calibration.stop();
     g_wheels.clear();
 }
 
@@ -558,33 +700,64 @@ SCSAPI_VOID telemetry_frame_start([[ maybe_unused ]] scs_event_t const event, vo
     g_telemetry_state.raw_rendering_timestamp = info->render_time;
     g_telemetry_state.raw_simulation_timestamp = info->simulation_time;
     g_telemetry_state.raw_paused_simulation_timestamp = info->paused_simulation_time;
+
+    g_frame_timing.frame_start(info->render_time, info->simulation_time,
+                               info->flags & SCS_TELEMETRY_FRAME_START_FLAG_timer_restart);
 }
 
 SCSAPI_VOID telemetry_frame_end([[ maybe_unused ]] scs_event_t const event,
                                 [[ maybe_unused ]] void const *const event_info,
                                 [[ maybe_unused ]] scs_context_t const context) {
-    if (g_telemetry_paused) {
-        reset_wheels();
-        return;
-    }
-    if (!update_wheels(g_telemetry_state)) {
-        g_game_log(SCS_LOG_TYPE_error, "g923mac::error : failed updating forces!");
+    auto const start = g923mac::frame_timing::clock::now();
+
+    if (!g_telemetry_paused.load(std::memory_order_relaxed)) {
+        g_telemetry_snapshot.publish(g_telemetry_state);
     }
+    flush_deferred_log();
 
-    g_terrain_state.last_vertical_accel = g_telemetry_state.linear_acceleration_y;
+    g_frame_timing.frame_end(g923mac::frame_timing::clock::now() - start);
 }
 
 SCSAPI_VOID telemetry_pause(scs_event_t const event, [[ maybe_unused ]] void const *const event_info,
                             [[ maybe_unused ]] scs_context_t const context) {
-    g_telemetry_paused = (event == SCS_TELEMETRY_EVENT_paused);
+    bool const paused = (event == SCS_TELEMETRY_EVENT_paused);
+    g_telemetry_paused.store(paused, std::memory_order_release);
 
-    if (g_telemetry_paused) {
-        reset_wheels();
+    if (paused) {
+        // the force loop stops the forces on its next tick
         g_game_log(SCS_LOG_TYPE_message, "g923mac::info : telemetry paused, stopped forces");
     } else {
     }
 }
 
+/// picks the tuning for the truck once per change of truck, the force loop only sees the profile it produces
+SCSAPI_VOID telemetry_configuration([[ maybe_unused ]] scs_event_t const event, void const *const event_info,
+                                    [[ maybe_unused ]] scs_context_t const context) {
+    scs_telemetry_configuration_t const *const info = static_cast<scs_telemetry_configuration_t const *>(event_info);
+
+    if (strcmp(info->id, SCS_TELEMETRY_CONFIG_truck) != 0) return;
+
+    // the game sends the configuration again on events that leave the truck as it was
+    g923mac::truck_config truck = g923mac::parse_truck_config(info->attributes);
+    if (truck == g_truck) return;
+
+    g_truck = std::move(truck);
+
+    g923mac::truck_selection const selection = g923mac::select_truck(g_truck);
+    g_tuned_profiles.tune(selection.tuning);
+
+    if (selection.kind == g923mac::truck_class::none) {
+        g_game_log(SCS_LOG_TYPE_message, "g923mac::info : no truck, force profile untuned");
+        return;
+    }
+
+    char message[256];
+    snprintf(message, sizeof(message), "g923mac::info : truck %s %s, %u wheels, %u steerable, %s%s tuning",
+             g_truck.brand.c_str(), g_truck.name.c_str(), g_truck.wheel_count, g_truck.steerable_wheels,
+             g923mac::truck_class_name(selection.kind), selection.known_model ? " model" : "");
+    g_game_log(SCS_LOG_TYPE_message, message);
+}
+
 SCSAPI_VOID telemetry_store_linear_velocity([[ maybe_unused ]] scs_string_t const name,
                                             [[ maybe_unused ]] scs_u32_t const index, scs_value_t const *const value,
                                             scs_context_t const context) {
@@ -747,6 +920,8 @@ SCSAPI_RESULT scs_telemetry_init(scs_u32_t const version, scs_telemetry_init_par
             (version_params->register_for_event(SCS_TELEMETRY_EVENT_paused, telemetry_pause, nullptr) == SCS_RESULT_ok)
             &&
             (version_params->register_for_event(SCS_TELEMETRY_EVENT_started, telemetry_pause, nullptr) ==
+             SCS_RESULT_ok) &&
+            (version_params->register_for_event(SCS_TELEMETRY_EVENT_configuration, telemetry_configuration, nullptr) ==
              SCS_RESULT_ok);
 
     if (!events_registered) {
@@ -822,28 +997,60 @@ SCSAPI_RESULT scs_telemetry_init(scs_u32_t const version, scs_telemetry_init_par
 
     g_game_log(SCS_LOG_TYPE_message, "g923mac::info : enhanced channel registration completed");
 
+    // the game sends the truck configuration again once registered
+    g_truck = g923mac::truck_config{};
+    g_tuned_profiles.tune(g923mac::neutral_tuning);
+
+    g_profile_watcher.start(profile_path(), std::chrono::milliseconds(g923mac::ffb_config::profile_poll_interval_ms),
+                            g_tuned_profiles, report_profile);
+
     g_game_log(SCS_LOG_TYPE_message, "g923mac::info : initializing wheel...");
-    if (!init_wheels()) {
-        g_game_log(SCS_LOG_TYPE_error, "ftl_ffb::error : failed to initialize wheel");
-        return SCS_RESULT_generic_error;
-    }
-    g_game_log(SCS_LOG_TYPE_message, "g923mac::info : wheel initialization successful");
+    init_wheels();
+    g_game_log(SCS_LOG_TYPE_message, "g923mac::info : calibrating wheels in the background");
 
     memset(&g_telemetry_state, 0, sizeof(g_telemetry_state));
+    g_telemetry_snapshot.publish(g_telemetry_state);
     memset(&g_terrain_state, 0, sizeof(g_terrain_state));
+    g_force_pipeline.reset_stats();
     g_last_timestamp = static_cast<scs_timestamp_t>(-1);
+    g_step_timestamp = 0; // the telemetry timestamp starts over from 0
+    g_predictor.reset();
+
+    g_telemetry_paused.store(true, std::memory_order_release);
+
+    g_frame_timing.reset();
+    g_motion_recording.clear();
+    if (g923mac::ffb_config::prediction_evaluation) {
+        g_motion_recording.reserve(g923mac::ffb_config::prediction_record_capacity);
+    }
 
-    g_telemetry_paused = true;
+    g_rate_controller = g923mac::rate_controller{};
+    g_next_rate_window = {};
+    g_rate_baseline = write_totals{0, 0}; // the new session's writers count from 0
+    g_force_loop.start(g923mac::period_of(g_rate_controller.rate_hz()), force_loop_tick);
 
     g_game_log(SCS_LOG_TYPE_message, "g923mac::info : successfully initialized");
     return SCS_RESULT_ok;
 }
 
 SCSAPI_VOID scs_telemetry_shutdown() {
+    g_force_loop.stop();
+    g_hotplug.stop(); // these post to g_deferred_log while they run
+    g_calibration.stop();
+    g_profile_watcher.stop();
+    flush_deferred_log();
+    log_force_loop_stats();
+    log_prediction_evaluation();
+    log_frame_timing();
+    log_wheel_stats();
+    log_effect_stage_costs();
+    log_write_latencies();
     g_game_log = nullptr;
     deinit_wheels();
 }
 
 void __attribute__(( destructor )) unload() {
     deinit_wheels();
+    g_profile_watcher.stop();
+    g_devices.reset();
 }